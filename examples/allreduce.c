@@ -0,0 +1,56 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../mimpi.h"
+#include "mimpi_err.h"
+#include "test.h"
+
+static uint8_t value(int rank, int k) {
+    return rank + 1 + k % 7;
+}
+
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+
+    int const world_rank = MIMPI_World_rank();
+    int const world_size = MIMPI_World_size();
+    int const data_len = atoi(argv[1]);
+
+    uint8_t *send_data = malloc(data_len);
+    uint8_t *recv_data = malloc(data_len);
+    assert(send_data && recv_data);
+
+    MIMPI_Op const ops[] = {MIMPI_PROD, MIMPI_SUM, MIMPI_MIN, MIMPI_MAX};
+    for (int i = 0; i < sizeof(ops) / sizeof(MIMPI_Op); ++i) {
+        MIMPI_Op const op = ops[i];
+        for (int k = 0; k < data_len; ++k)
+            send_data[k] = value(world_rank, k);
+        memset(recv_data, 0, data_len);
+
+        // second time in place
+        ASSERT_MIMPI_OK(MIMPI_Allreduce(send_data, recv_data, data_len, op));
+        ASSERT_MIMPI_OK(MIMPI_Allreduce(send_data, send_data, data_len, op));
+
+        for (int k = 0; k < data_len; ++k) {
+            uint8_t result = value(0, k);
+            for (int r = 1; r < world_size; ++r) {
+                uint8_t const v = value(r, k);
+                if (op == MIMPI_PROD) result *= v;
+                else if (op == MIMPI_SUM) result += v;
+                else if (op == MIMPI_MIN) result = v < result ? v : result;
+                else result = v > result ? v : result;
+            }
+            test_assert(recv_data[k] == result);
+            test_assert(send_data[k] == result);
+        }
+    }
+
+    free(send_data);
+    free(recv_data);
+    MIMPI_Finalize();
+    return test_success();
+}
@@ -0,0 +1,79 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../mimpi.h"
+#include "mimpi_err.h"
+#include "test.h"
+
+static uint8_t value(int from, int to, int k) {
+    return (uint8_t)(from * 31 + to * 7 + k);
+}
+
+// process from sends this many bytes to process to in MIMPI_Alltoallv
+static int v_count(int from, int to, int count) {
+    return (from + to) % 3 * count;
+}
+
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+
+    int const world_rank = MIMPI_World_rank();
+    int const world_size = MIMPI_World_size();
+
+    uint8_t *send_data = malloc(3 * 1000 * world_size);
+    uint8_t *recv_data = malloc(3 * 1000 * world_size);
+    assert(send_data && recv_data);
+
+    // small blocks with Bruck's algorithm, large pairwise
+    int const counts[] = {0, 1, 10, 1000};
+    for (int i = 0; i < sizeof(counts) / sizeof(int); ++i)
+    {
+        int const count = counts[i];
+        for (int to = 0; to < world_size; ++to)
+            for (int k = 0; k < count; ++k)
+                send_data[to * count + k] = value(world_rank, to, k);
+        memset(recv_data, 0, count * world_size);
+
+        ASSERT_MIMPI_OK(MIMPI_Alltoall(send_data, recv_data, count));
+        for (int from = 0; from < world_size; ++from)
+            for (int k = 0; k < count; ++k)
+                test_assert(recv_data[from * count + k] == value(from, world_rank, k));
+
+        double step_times[16];
+        int steps, log_steps = 0;
+        while ((1 << log_steps) < world_size)
+            log_steps++;
+        ASSERT_MIMPI_OK(MIMPI_Alltoall_timing(step_times, 16, &steps));
+        test_assert(steps == (count < 256 ? log_steps : world_size - 1));
+        for (int s = 0; s < steps; ++s)
+            test_assert(step_times[s] >= 0);
+    }
+
+    int const count = 500;
+    int send_counts[16], send_displs[16], recv_counts[16], recv_displs[16];
+    int send_total = 0, recv_total = 0;
+    for (int r = 0; r < world_size; ++r)
+    {
+        send_counts[r] = v_count(world_rank, r, count);
+        send_displs[r] = send_total;
+        for (int k = 0; k < send_counts[r]; ++k)
+            send_data[send_total + k] = value(world_rank, r, k);
+        send_total += send_counts[r];
+        recv_counts[r] = v_count(r, world_rank, count);
+        recv_displs[r] = recv_total;
+        recv_total += recv_counts[r];
+    }
+    ASSERT_MIMPI_OK(MIMPI_Alltoallv(send_data, send_counts, send_displs, recv_data, recv_counts, recv_displs));
+    for (int from = 0; from < world_size; ++from)
+        for (int k = 0; k < recv_counts[from]; ++k)
+            test_assert(recv_data[recv_displs[from] + k] == value(from, world_rank, k));
+
+    free(send_data);
+    free(recv_data);
+    MIMPI_Finalize();
+    return test_success();
+}
@@ -0,0 +1,35 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../mimpi.h"
+#include "mimpi_err.h"
+#include "test.h"
+
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+
+    int const world_rank = MIMPI_World_rank();
+    int const world_size = MIMPI_World_size();
+
+    // barriers of both kinds mixed with other collectives
+    for (int i = 0; i < 50; ++i) {
+        ASSERT_MIMPI_OK(MIMPI_Set_barrier_algorithm(i % 3 == 0 ? MIMPI_BARRIER_TREE : MIMPI_BARRIER_DISSEMINATION));
+        ASSERT_MIMPI_OK(MIMPI_Barrier());
+
+        char data = world_rank == i % world_size ? i : -1;
+        ASSERT_MIMPI_OK(MIMPI_Bcast(&data, 1, i % world_size));
+        test_assert(data == i);
+        ASSERT_MIMPI_OK(MIMPI_Barrier());
+
+        char const one = 1;
+        char sum = 0;
+        ASSERT_MIMPI_OK(MIMPI_Reduce(&one, &sum, 1, MIMPI_SUM, 0));
+        if (world_rank == 0)
+            test_assert(sum == world_size);
+    }
+
+    MIMPI_Finalize();
+    return test_success();
+}
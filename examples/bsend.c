@@ -0,0 +1,84 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../mimpi.h"
+#include "mimpi_err.h"
+#include "test.h"
+
+#define MESSAGES 500
+#define BUFFER_SIZE 4096
+
+static int message_size(int i)
+{
+    return (i * 37) % 700;
+}
+
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+
+    int const world_rank = MIMPI_World_rank();
+
+    char data[1000];
+    if (world_rank == 0)
+    {
+        ASSERT_MIMPI_RETCODE(MIMPI_Bsend(data, 1, 1, 1), MIMPI_ERROR_BUFFER_OVERFLOW);
+
+        char *buffer = malloc(BUFFER_SIZE);
+        ASSERT_MIMPI_OK(MIMPI_Buffer_attach(buffer, BUFFER_SIZE));
+        ASSERT_MIMPI_RETCODE(MIMPI_Bsend(buffer, BUFFER_SIZE, 1, 1), MIMPI_ERROR_BUFFER_OVERFLOW);
+
+        for (int i = 0; i < MESSAGES; i++)
+        {
+            for (int j = 0; j < message_size(i); j++)
+                data[j] = (char)(i + j);
+            MIMPI_Retcode res;
+            while ((res = MIMPI_Bsend(data, message_size(i), 1, 1)) == MIMPI_ERROR_BUFFER_OVERFLOW)
+            {
+                // make room by waiting for everything to be sent
+                void *detached;
+                int size;
+                ASSERT_MIMPI_OK(MIMPI_Buffer_detach(&detached, &size));
+                assert(detached == buffer && size == BUFFER_SIZE);
+                ASSERT_MIMPI_OK(MIMPI_Buffer_attach(buffer, BUFFER_SIZE));
+            }
+            ASSERT_MIMPI_OK(res);
+            if (i % 50 == 0)
+                ASSERT_MIMPI_OK(MIMPI_Send(&i, sizeof(int), 1, 1));
+        }
+
+        MIMPI_Buffer_usage usage;
+        ASSERT_MIMPI_OK(MIMPI_Buffer_stats(&usage));
+        assert(usage.size == BUFFER_SIZE);
+        assert(usage.peak_used > 0 && usage.peak_used <= BUFFER_SIZE);
+        assert(usage.failed == 0);
+
+        void *detached;
+        int size;
+        ASSERT_MIMPI_OK(MIMPI_Buffer_detach(&detached, &size));
+        ASSERT_MIMPI_OK(MIMPI_Buffer_stats(&usage));
+        assert(usage.size == 0 && usage.pending == 0 && usage.used == 0);
+        free(buffer);
+    }
+    else if (world_rank == 1)
+    {
+        for (int i = 0; i < MESSAGES; i++)
+        {
+            MIMPI_Status status;
+            ASSERT_MIMPI_OK(MIMPI_Recv_status(data, sizeof(data), 0, 1, &status));
+            assert(status.count == message_size(i));
+            for (int j = 0; j < message_size(i); j++)
+                assert(data[j] == (char)(i + j));
+            if (i % 50 == 0)
+            {
+                ASSERT_MIMPI_OK(MIMPI_Recv_status(data, sizeof(data), 0, 1, &status));
+                assert(status.count == sizeof(int) && *(int *)data == i);
+            }
+        }
+        printf("Process 1 received all buffered messages in order\n");
+    }
+
+    MIMPI_Finalize();
+    return test_success();
+}
@@ -0,0 +1,96 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../mimpi.h"
+#include "mimpi_err.h"
+#include "test.h"
+
+static MIMPI_Comm copies[2];
+
+// each thread runs collectives of its own communicator at the same time
+static void *sum_ranks(void *arg) {
+    MIMPI_Comm comm = copies[*(int*)arg];
+    int rank, size;
+    ASSERT_MIMPI_OK(MIMPI_Comm_rank(comm, &rank));
+    ASSERT_MIMPI_OK(MIMPI_Comm_size(comm, &size));
+    for (int i = 0; i < 10; ++i) {
+        char const value = rank;
+        char sum = -1;
+        ASSERT_MIMPI_OK(MIMPI_Comm_reduce(&value, &sum, 1, MIMPI_SUM, size - 1, comm));
+        ASSERT_MIMPI_OK(MIMPI_Comm_bcast(&sum, 1, size - 1, comm));
+        test_assert(sum == size * (size - 1) / 2);
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    MIMPI_Init(true);
+
+    int const world_rank = MIMPI_World_rank();
+    int const world_size = MIMPI_World_size();
+
+    // processes of the same parity, in reversed order
+    MIMPI_Comm parity;
+    ASSERT_MIMPI_OK(MIMPI_Comm_split(MIMPI_COMM_WORLD, world_rank % 2, -world_rank, &parity));
+    int rank, size;
+    ASSERT_MIMPI_OK(MIMPI_Comm_rank(parity, &rank));
+    ASSERT_MIMPI_OK(MIMPI_Comm_size(parity, &size));
+    test_assert(size == (world_size + 1 - world_rank % 2) / 2);
+    test_assert(rank == size - 1 - world_rank / 2);
+
+    int data = world_rank;
+    ASSERT_MIMPI_OK(MIMPI_Comm_bcast(&data, sizeof(int), 0, parity));
+    test_assert(data % 2 == world_rank % 2 && data >= world_size - 2);
+    ASSERT_MIMPI_OK(MIMPI_Comm_barrier(parity));
+
+    // only process 0 passes a color
+    MIMPI_Comm alone = MIMPI_COMM_WORLD;
+    ASSERT_MIMPI_OK(MIMPI_Comm_split(parity, world_rank == 0 ? 0 : -1, 0, &alone));
+    if (world_rank == 0) {
+        ASSERT_MIMPI_OK(MIMPI_Comm_size(alone, &size));
+        test_assert(size == 1);
+        ASSERT_MIMPI_OK(MIMPI_Comm_free(&alone));
+    }
+    test_assert(alone == MIMPI_COMM_WORLD);
+    ASSERT_MIMPI_OK(MIMPI_Comm_free(&parity));
+
+    // messages with the same tag don't mix between communicators
+    MIMPI_Comm first, second;
+    ASSERT_MIMPI_OK(MIMPI_Comm_dup(MIMPI_COMM_WORLD, &first));
+    ASSERT_MIMPI_OK(MIMPI_Comm_dup(first, &second));
+    if (world_size > 1) {
+        if (world_rank == 0) {
+            int const one = 1, two = 2, three = 3;
+            ASSERT_MIMPI_OK(MIMPI_Comm_send(&one, sizeof(int), 1, 7, first));
+            ASSERT_MIMPI_OK(MIMPI_Comm_send(&two, sizeof(int), 1, 7, second));
+            ASSERT_MIMPI_OK(MIMPI_Send(&three, sizeof(int), 1, 7));
+        } else if (world_rank == 1) {
+            ASSERT_MIMPI_OK(MIMPI_Recv(&data, sizeof(int), 0, 7));
+            test_assert(data == 3);
+            ASSERT_MIMPI_OK(MIMPI_Comm_recv(&data, sizeof(int), 0, 7, second));
+            test_assert(data == 2);
+            ASSERT_MIMPI_OK(MIMPI_Comm_recv(&data, sizeof(int), 0, 7, first));
+            test_assert(data == 1);
+        }
+    }
+    ASSERT_MIMPI_RETCODE(MIMPI_Comm_send(&data, sizeof(int), world_size, 7, first), MIMPI_ERROR_NO_SUCH_RANK);
+    ASSERT_MIMPI_OK(MIMPI_Comm_free(&first));
+    ASSERT_MIMPI_OK(MIMPI_Comm_free(&second));
+
+    ASSERT_MIMPI_OK(MIMPI_Comm_dup(MIMPI_COMM_WORLD, &copies[0]));
+    ASSERT_MIMPI_OK(MIMPI_Comm_dup(MIMPI_COMM_WORLD, &copies[1]));
+    pthread_t threads[2];
+    int indices[2] = {0, 1};
+    for (int i = 0; i < 2; ++i)
+        test_assert(pthread_create(&threads[i], NULL, sum_ranks, &indices[i]) == 0);
+    for (int i = 0; i < 2; ++i)
+        test_assert(pthread_join(threads[i], NULL) == 0);
+    ASSERT_MIMPI_OK(MIMPI_Comm_free(&copies[0]));
+    ASSERT_MIMPI_OK(MIMPI_Comm_free(&copies[1]));
+
+    MIMPI_Finalize();
+    return test_success();
+}
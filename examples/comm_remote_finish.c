@@ -0,0 +1,41 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include "../mimpi.h"
+#include "mimpi_err.h"
+#include "test.h"
+
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+
+    int const world_rank = MIMPI_World_rank();
+
+    // pairs {0, 1} and {2, 3}
+    MIMPI_Comm pair;
+    ASSERT_MIMPI_OK(MIMPI_Comm_split(MIMPI_COMM_WORLD, world_rank / 2, world_rank, &pair));
+
+    if (world_rank == 2)
+    {
+        // process 3 skips the barrier, only its pair should notice
+        ASSERT_MIMPI_RETCODE(MIMPI_Comm_barrier(pair), MIMPI_ERROR_REMOTE_FINISHED);
+        ASSERT_MIMPI_OK(MIMPI_Send(NULL, 0, 0, 1));
+    }
+    else if (world_rank < 2)
+    {
+        // the other pair still synchronizes after the failure
+        if (world_rank == 0)
+        {
+            ASSERT_MIMPI_OK(MIMPI_Recv(NULL, 0, 2, 1));
+            ASSERT_MIMPI_OK(MIMPI_Send(NULL, 0, 1, 1));
+        }
+        else
+        {
+            ASSERT_MIMPI_OK(MIMPI_Recv(NULL, 0, 0, 1));
+        }
+        ASSERT_MIMPI_OK(MIMPI_Comm_barrier(pair));
+    }
+    ASSERT_MIMPI_OK(MIMPI_Comm_free(&pair));
+
+    MIMPI_Finalize();
+    return test_success();
+}
@@ -0,0 +1,118 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../mimpi.h"
+#include "mimpi_err.h"
+#include "test.h"
+
+#define N 100
+
+typedef struct
+{
+    int a;
+    char b;
+    double c;
+} item;
+
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+
+    int const world_rank = MIMPI_World_rank();
+
+    static int matrix[N][N];
+    MIMPI_Datatype column;
+    ASSERT_MIMPI_OK(MIMPI_Type_vector(N, sizeof(int), N * sizeof(int), MIMPI_BYTE, &column));
+    int size;
+    ASSERT_MIMPI_OK(MIMPI_Type_size(column, &size));
+    assert(size == N * sizeof(int));
+
+    MIMPI_Datatype item_type;
+    int blocklengths[3] = {sizeof(int), 1, sizeof(double)};
+    int displacements[3] = {offsetof(item, a), offsetof(item, b), offsetof(item, c)};
+    MIMPI_Datatype types[3] = {MIMPI_BYTE, MIMPI_BYTE, MIMPI_BYTE};
+    ASSERT_MIMPI_OK(MIMPI_Type_create_struct(3, blocklengths, displacements, types, &item_type));
+    ASSERT_MIMPI_OK(MIMPI_Type_size(item_type, &size));
+    assert(size == sizeof(int) + 1 + sizeof(double));
+
+    // every other item of an array, packed and unpacked locally
+    MIMPI_Datatype every_other;
+    int item_blocks[2] = {1, 1};
+    int item_displacements[2] = {0, 2};
+    ASSERT_MIMPI_OK(MIMPI_Type_indexed(2, item_blocks, item_displacements, item_type, &every_other));
+    item items[8], unpacked[8];
+    memset(items, 0, sizeof(items));
+    memset(unpacked, 0, sizeof(unpacked));
+    for (int i = 0; i < 8; i++)
+        items[i] = (item){.a = i, .b = (char)(i * 3), .c = i / 2.0};
+    char packed[8 * sizeof(item)];
+    ASSERT_MIMPI_OK(MIMPI_Pack(items, 2, every_other, packed));
+    ASSERT_MIMPI_OK(MIMPI_Unpack(packed, unpacked, 2, every_other));
+    for (int i = 0; i < 8; i++)
+    {
+        // each element spans three items, of which the first and the last are taken
+        bool sent = (i == 0 || i == 2 || i == 3 || i == 5);
+        assert(unpacked[i].a == (sent ? items[i].a : 0));
+        assert(unpacked[i].c == (sent ? items[i].c : 0));
+    }
+
+    if (world_rank == 0)
+    {
+        for (int i = 0; i < N; i++)
+            for (int j = 0; j < N; j++)
+                matrix[i][j] = i * N + j;
+
+        ASSERT_MIMPI_OK(MIMPI_Send_typed(&matrix[0][3], 1, column, 1, 1));
+        ASSERT_MIMPI_OK(MIMPI_Send_typed(&matrix[0][7], 1, column, 1, 1));
+        ASSERT_MIMPI_OK(MIMPI_Send_typed(items, 8, item_type, 1, 2));
+
+        char a[10], b[1000], c[3];
+        memset(a, 1, sizeof(a));
+        memset(b, 2, sizeof(b));
+        memset(c, 3, sizeof(c));
+        struct iovec iov[3] = {{a, sizeof(a)}, {b, sizeof(b)}, {c, sizeof(c)}};
+        ASSERT_MIMPI_OK(MIMPI_Sendv(iov, 3, 1, 3));
+        ASSERT_MIMPI_OK(MIMPI_Sendv(iov, 3, 1, 3));
+    }
+    else if (world_rank == 1)
+    {
+        int column_data[N];
+        ASSERT_MIMPI_OK(MIMPI_Recv(column_data, sizeof(column_data), 0, 1));
+        for (int i = 0; i < N; i++)
+            assert(column_data[i] == i * N + 3);
+
+        ASSERT_MIMPI_OK(MIMPI_Recv_typed(&matrix[0][5], 1, column, 0, 1));
+        for (int i = 0; i < N; i++)
+            for (int j = 0; j < N; j++)
+                assert(matrix[i][j] == (j == 5 ? i * N + 7 : 0));
+
+        item received[8];
+        memset(received, 0, sizeof(received));
+        ASSERT_MIMPI_OK(MIMPI_Recv_typed(received, 8, item_type, 0, 2));
+        for (int i = 0; i < 8; i++)
+            assert(received[i].a == i && received[i].b == (char)(i * 3) && received[i].c == i / 2.0);
+
+        char whole[1013];
+        ASSERT_MIMPI_OK(MIMPI_Recv(whole, sizeof(whole), 0, 3));
+        for (int i = 0; i < 1013; i++)
+            assert(whole[i] == (i < 10 ? 1 : (i < 1010 ? 2 : 3)));
+
+        char x[500], y[513];
+        struct iovec iov[2] = {{x, sizeof(x)}, {y, sizeof(y)}};
+        ASSERT_MIMPI_OK(MIMPI_Recvv(iov, 2, 0, 3));
+        for (int i = 0; i < 1013; i++)
+            assert((i < 500 ? x[i] : y[i - 500]) == (i < 10 ? 1 : (i < 1010 ? 2 : 3)));
+        printf("Process 1 received all strided data\n");
+    }
+
+    ASSERT_MIMPI_OK(MIMPI_Type_free(&every_other));
+    ASSERT_MIMPI_OK(MIMPI_Type_free(&item_type));
+    ASSERT_MIMPI_OK(MIMPI_Type_free(&column));
+    assert(column == MIMPI_BYTE);
+
+    MIMPI_Finalize();
+    return test_success();
+}
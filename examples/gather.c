@@ -0,0 +1,71 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../mimpi.h"
+#include "mimpi_err.h"
+#include "test.h"
+
+static uint8_t value(int rank, int k) {
+    return (uint8_t)(rank * 31 + k);
+}
+
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+
+    int const world_rank = MIMPI_World_rank();
+    int const world_size = MIMPI_World_size();
+    int const count = atoi(argv[1]);
+
+    uint8_t *send_data = malloc(count * world_size + 1);
+    uint8_t *recv_data = malloc(count * world_size * world_size + 1);
+    assert(send_data && recv_data);
+
+    for (int k = 0; k < count * world_size; ++k)
+        send_data[k] = value(world_rank, k);
+
+    for (int root = 0; root < world_size; ++root)
+    {
+        memset(recv_data, 0, count * world_size);
+        ASSERT_MIMPI_OK(MIMPI_Gather(send_data, recv_data, count, root));
+        if (world_rank == root)
+            for (int r = 0; r < world_size; ++r)
+                for (int k = 0; k < count; ++k)
+                    test_assert(recv_data[r * count + k] == value(r, k));
+    }
+
+    // process r sends r * count bytes, stored in reverse rank order
+    int recv_counts[16], displs[16];
+    int total = 0;
+    for (int r = world_size - 1; r >= 0; --r)
+    {
+        recv_counts[r] = r * count;
+        displs[r] = total;
+        total += recv_counts[r];
+    }
+    int const root = world_size / 2;
+    ASSERT_MIMPI_OK(MIMPI_Gatherv(send_data, world_rank * count, recv_data, recv_counts, displs, root));
+    if (world_rank == root)
+        for (int r = 0; r < world_size; ++r)
+            for (int k = 0; k < recv_counts[r]; ++k)
+                test_assert(recv_data[displs[r] + k] == value(r, k));
+
+    // large enough to go around the ring
+    for (int i = 0; i < 2; ++i)
+    {
+        int const times = (i == 0 ? 1 : world_size);
+        memset(recv_data, 0, count * times * world_size);
+        ASSERT_MIMPI_OK(MIMPI_Allgather(send_data, recv_data, count * times));
+        for (int r = 0; r < world_size; ++r)
+            for (int k = 0; k < count * times; ++k)
+                test_assert(recv_data[r * count * times + k] == value(r, k));
+    }
+
+    free(send_data);
+    free(recv_data);
+    MIMPI_Finalize();
+    return test_success();
+}
@@ -0,0 +1,50 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "../mimpi.h"
+#include "mimpi_err.h"
+#include "test.h"
+
+#define WRITE_VAR "CHANNELS_WRITE_DELAY"
+
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+    int const world_rank = MIMPI_World_rank();
+    int const world_size = MIMPI_World_size();
+    int const data_len = atoi(argv[1]);
+
+    char *data = malloc(data_len + 1);
+    assert(data);
+
+    const char *delay = getenv("DELAY");
+    if (delay)
+    {
+        int res = setenv(WRITE_VAR, delay, true);
+        assert(res == 0);
+    }
+
+    int const root = world_size - 1;
+    for (int k = 0; k < data_len; ++k)
+        data[k] = world_rank == root ? k % 101 : -1;
+    // a persistent request when asked for
+    if (argc > 2) {
+        MIMPI_Request request;
+        ASSERT_MIMPI_OK(MIMPI_Bcast_init(data, data_len, root, &request));
+        ASSERT_MIMPI_OK(MIMPI_Start(&request));
+        ASSERT_MIMPI_OK(MIMPI_Wait(&request));
+        ASSERT_MIMPI_OK(MIMPI_Request_free(&request));
+    }
+    else
+        ASSERT_MIMPI_OK(MIMPI_Bcast(data, data_len, root));
+    for (int k = 0; k < data_len; ++k)
+        test_assert(data[k] == k % 101);
+
+    int res = unsetenv(WRITE_VAR);
+    assert(res == 0);
+
+    free(data);
+    MIMPI_Finalize();
+    return test_success();
+}
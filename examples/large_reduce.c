@@ -0,0 +1,63 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "../mimpi.h"
+#include "mimpi_err.h"
+#include "test.h"
+
+#define WRITE_VAR "CHANNELS_WRITE_DELAY"
+
+static char value(int rank, int k) {
+    return (rank + k) % 7;
+}
+
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+    int const world_rank = MIMPI_World_rank();
+    int const world_size = MIMPI_World_size();
+    int const data_len = atoi(argv[1]);
+
+    char *send_data = malloc(data_len + 1);
+    char *recv_data = malloc(data_len + 1);
+    assert(send_data && recv_data);
+    for (int k = 0; k < data_len; ++k)
+        send_data[k] = value(world_rank, k);
+
+    const char *delay = getenv("DELAY");
+    if (delay)
+    {
+        int res = setenv(WRITE_VAR, delay, true);
+        assert(res == 0);
+    }
+
+    int const root = argc > 2 ? atoi(argv[2]) : world_size - 1;
+    // a persistent request when asked for
+    if (argc > 3) {
+        MIMPI_Request request;
+        ASSERT_MIMPI_OK(MIMPI_Reduce_init(send_data, recv_data, data_len, MIMPI_SUM, root, &request));
+        ASSERT_MIMPI_OK(MIMPI_Start(&request));
+        ASSERT_MIMPI_OK(MIMPI_Wait(&request));
+        ASSERT_MIMPI_OK(MIMPI_Request_free(&request));
+    }
+    else
+        ASSERT_MIMPI_OK(MIMPI_Reduce(send_data, recv_data, data_len, MIMPI_SUM, root));
+
+    int res = unsetenv(WRITE_VAR);
+    assert(res == 0);
+
+    if (world_rank == root) {
+        for (int k = 0; k < data_len; ++k) {
+            char sum = 0;
+            for (int r = 0; r < world_size; ++r)
+                sum += value(r, k);
+            test_assert(recv_data[k] == sum);
+        }
+    }
+
+    free(send_data);
+    free(recv_data);
+    MIMPI_Finalize();
+    return test_success();
+}
@@ -0,0 +1,65 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../mimpi.h"
+#include "mimpi_err.h"
+#include "test.h"
+
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+
+    int const world_rank = MIMPI_World_rank();
+    int const world_size = MIMPI_World_size();
+
+    // a grid periodic in the first dimension only
+    int const dims[3] = {world_size % 2 == 0 ? world_size / 2 : world_size, world_size % 2 == 0 ? 2 : 1, 1};
+    bool const periods[3] = {true, false, true};
+    MIMPI_Topology grid;
+    ASSERT_MIMPI_RETCODE(MIMPI_Cart_create(2, (int[]){world_size + 1, 1}, periods, false, &grid), MIMPI_ERROR_INVALID_TOPOLOGY);
+    ASSERT_MIMPI_OK(MIMPI_Cart_create(3, dims, periods, true, &grid));
+
+    int coords[3];
+    ASSERT_MIMPI_OK(MIMPI_Cart_coords(grid, world_rank, coords));
+    test_assert(coords[0] * dims[1] + coords[1] == world_rank && coords[2] == 0);
+
+    int indegree, outdegree, sources[6], destinations[6];
+    ASSERT_MIMPI_OK(MIMPI_Topology_neighbors(grid, &indegree, sources, &outdegree, destinations));
+    test_assert(indegree == 6 && outdegree == 6);
+    test_assert(sources[0] == (world_rank - dims[1] + world_size) % world_size);
+    test_assert(sources[1] == (world_rank + dims[1]) % world_size);
+    test_assert(sources[2] == (coords[1] == 0 ? MIMPI_PROC_NULL : world_rank - 1));
+    test_assert(sources[3] == (coords[1] == dims[1] - 1 ? MIMPI_PROC_NULL : world_rank + 1));
+    test_assert(sources[4] == world_rank && sources[5] == world_rank);
+
+    int received[6];
+    for (int i = 0; i < 6; ++i)
+        received[i] = -2;
+    ASSERT_MIMPI_OK(MIMPI_Neighbor_allgather(&world_rank, received, sizeof(int), grid));
+    for (int i = 0; i < 6; ++i)
+        test_assert(received[i] == (sources[i] == MIMPI_PROC_NULL ? -2 : sources[i]));
+
+    // what process r sends to its j-th neighbour
+    int sent[6];
+    for (int j = 0; j < 6; ++j)
+        sent[j] = world_rank * 100 + j;
+    ASSERT_MIMPI_OK(MIMPI_Neighbor_alltoall(sent, received, sizeof(int), grid));
+    for (int i = 0; i < 6; ++i)
+        if (sources[i] != MIMPI_PROC_NULL)
+            test_assert(received[i] == sources[i] * 100 + (i ^ 1));
+    ASSERT_MIMPI_OK(MIMPI_Topology_free(&grid));
+    test_assert(grid == MIMPI_TOPOLOGY_NULL);
+
+    // a ring with every process also its own neighbour
+    MIMPI_Topology ring;
+    int const ring_sources[2] = {(world_rank + world_size - 1) % world_size, world_rank};
+    int const ring_destinations[2] = {(world_rank + 1) % world_size, world_rank};
+    ASSERT_MIMPI_OK(MIMPI_Dist_graph_create(2, ring_sources, 2, ring_destinations, false, &ring));
+    ASSERT_MIMPI_OK(MIMPI_Neighbor_alltoall(sent, received, sizeof(int), ring));
+    test_assert(received[0] == ring_sources[0] * 100 && received[1] == world_rank * 100 + 1);
+    ASSERT_MIMPI_OK(MIMPI_Topology_free(&ring));
+
+    MIMPI_Finalize();
+    return test_success();
+}
@@ -0,0 +1,71 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "../mimpi.h"
+#include "mimpi_err.h"
+#include "test.h"
+
+#define DATA_LEN 1000
+
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+
+    int const world_rank = MIMPI_World_rank();
+    int const world_size = MIMPI_World_size();
+
+    // the barrier can't complete before process 0 joins it
+    if (world_rank == 0)
+        usleep(200000);
+    MIMPI_Request request;
+    bool flag;
+    ASSERT_MIMPI_OK(MIMPI_Ibarrier(&request));
+    ASSERT_MIMPI_OK(MIMPI_Test(&request, &flag));
+    if (world_rank != 0)
+        test_assert(!flag && request != MIMPI_REQUEST_NULL);
+    while (!flag)
+    {
+        usleep(1000);
+        ASSERT_MIMPI_OK(MIMPI_Test(&request, &flag));
+    }
+    test_assert(request == MIMPI_REQUEST_NULL);
+
+    // several in flight, then a blocking one after them
+    uint8_t bcast_data[DATA_LEN], send_data[DATA_LEN], recv_data[DATA_LEN];
+    int const root = world_size - 1;
+    for (int k = 0; k < DATA_LEN; ++k)
+    {
+        bcast_data[k] = (world_rank == root ? (uint8_t)k : 0);
+        send_data[k] = world_rank + 1;
+    }
+    MIMPI_Request requests[2];
+    ASSERT_MIMPI_OK(MIMPI_Ibcast(bcast_data, DATA_LEN, root, &requests[0]));
+    ASSERT_MIMPI_OK(MIMPI_Ireduce(send_data, recv_data, DATA_LEN, MIMPI_SUM, root, &requests[1]));
+    ASSERT_MIMPI_OK(MIMPI_Barrier());
+    ASSERT_MIMPI_OK(MIMPI_Test(&requests[0], &flag));
+    test_assert(flag);
+    ASSERT_MIMPI_OK(MIMPI_Waitall(2, requests));
+    test_assert(requests[0] == MIMPI_REQUEST_NULL && requests[1] == MIMPI_REQUEST_NULL);
+
+    for (int k = 0; k < DATA_LEN; ++k)
+    {
+        test_assert(bcast_data[k] == (uint8_t)k);
+        if (world_rank == root)
+            test_assert(recv_data[k] == (uint8_t)(world_size * (world_size + 1) / 2));
+    }
+
+    ASSERT_MIMPI_RETCODE(MIMPI_Ibcast(bcast_data, DATA_LEN, world_size, &request), MIMPI_ERROR_NO_SUCH_RANK);
+
+    // completed by the blocking barrier after it
+    ASSERT_MIMPI_OK(MIMPI_Ibarrier(&request));
+    ASSERT_MIMPI_OK(MIMPI_Barrier());
+    test_assert(MIMPI_Test(&request, &flag) == MIMPI_SUCCESS && flag);
+    test_assert(request == MIMPI_REQUEST_NULL);
+
+    MIMPI_Finalize();
+    return test_success();
+}
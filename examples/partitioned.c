@@ -0,0 +1,90 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../mimpi.h"
+#include "mimpi_err.h"
+#include "test.h"
+
+#define PARTITIONS 4
+#define PART_SIZE 1000
+#define ROUNDS 3
+
+static char data[PARTITIONS * PART_SIZE];
+static MIMPI_Request request;
+static int round_no;
+
+static void *producer(void *arg)
+{
+    int part = *(int *)arg;
+    for (int i = 0; i < PART_SIZE; i++)
+        data[part * PART_SIZE + i] = (char)(round_no + part + i);
+    ASSERT_MIMPI_OK(MIMPI_Pready(part, request));
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+
+    int const world_rank = MIMPI_World_rank();
+    char ping = 0;
+
+    if (world_rank == 0)
+    {
+        ASSERT_MIMPI_OK(MIMPI_Psend_init(data, PARTITIONS, PART_SIZE, 1, 1, &request));
+        for (round_no = 0; round_no < ROUNDS; round_no++)
+        {
+            ASSERT_MIMPI_OK(MIMPI_Start(&request));
+            int parts[PARTITIONS];
+            pthread_t threads[PARTITIONS];
+
+            // first partition alone, so that the receiver can see it before the others
+            parts[0] = 0;
+            producer(&parts[0]);
+            ASSERT_MIMPI_OK(MIMPI_Send(&ping, 1, 1, 2));
+            ASSERT_MIMPI_OK(MIMPI_Recv(&ping, 1, 1, 2));
+
+            for (int i = 1; i < PARTITIONS; i++)
+            {
+                parts[i] = i;
+                assert(pthread_create(&threads[i], NULL, producer, &parts[i]) == 0);
+            }
+            for (int i = 1; i < PARTITIONS; i++)
+                assert(pthread_join(threads[i], NULL) == 0);
+            ASSERT_MIMPI_OK(MIMPI_Wait(&request));
+        }
+    }
+    else if (world_rank == 1)
+    {
+        char received[PARTITIONS * PART_SIZE];
+        ASSERT_MIMPI_OK(MIMPI_Precv_init(received, PARTITIONS, PART_SIZE, 0, 1, &request));
+        for (round_no = 0; round_no < ROUNDS; round_no++)
+        {
+            ASSERT_MIMPI_OK(MIMPI_Start(&request));
+            ASSERT_MIMPI_OK(MIMPI_Recv(&ping, 1, 0, 2));
+
+            bool flag;
+            ASSERT_MIMPI_OK(MIMPI_Parrived(request, 0, &flag));
+            assert(flag);
+            for (int i = 0; i < PART_SIZE; i++)
+                assert(received[i] == (char)(round_no + i));
+            ASSERT_MIMPI_OK(MIMPI_Parrived(request, 1, &flag));
+            assert(!flag);
+            ASSERT_MIMPI_OK(MIMPI_Send(&ping, 1, 0, 2));
+
+            ASSERT_MIMPI_OK(MIMPI_Wait(&request));
+            for (int part = 0; part < PARTITIONS; part++)
+                for (int i = 0; i < PART_SIZE; i++)
+                    assert(received[part * PART_SIZE + i] == (char)(round_no + part + i));
+        }
+        printf("Process 1 received all partitions\n");
+    }
+
+    if (world_rank < 2)
+        ASSERT_MIMPI_OK(MIMPI_Request_free(&request));
+
+    MIMPI_Finalize();
+    return test_success();
+}
@@ -0,0 +1,57 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../mimpi.h"
+#include "mimpi_err.h"
+#include "test.h"
+
+#define ITERATIONS 1000
+
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+
+    int const world_rank = MIMPI_World_rank();
+    int const world_size = MIMPI_World_size();
+
+    int const right = (world_rank + 1) % world_size;
+    int const left = (world_rank + world_size - 1) % world_size;
+
+    int to_left, to_right, from_left, from_right;
+    MIMPI_Request requests[4];
+    ASSERT_MIMPI_OK(MIMPI_Recv_init(&from_left, sizeof(int), left, 1, &requests[0]));
+    ASSERT_MIMPI_OK(MIMPI_Recv_init(&from_right, sizeof(int), right, 2, &requests[1]));
+    ASSERT_MIMPI_OK(MIMPI_Send_init(&to_right, sizeof(int), right, 1, &requests[2]));
+    ASSERT_MIMPI_OK(MIMPI_Send_init(&to_left, sizeof(int), left, 2, &requests[3]));
+
+    MIMPI_Request bad;
+    ASSERT_MIMPI_RETCODE(MIMPI_Send_init(&to_left, sizeof(int), world_rank, 1, &bad), MIMPI_ERROR_ATTEMPTED_SELF_OP);
+    ASSERT_MIMPI_RETCODE(MIMPI_Recv_init(&to_left, sizeof(int), world_size, 1, &bad), MIMPI_ERROR_NO_SUCH_RANK);
+
+    for (int i = 0; i < ITERATIONS; i++)
+    {
+        to_left = to_right = world_rank * ITERATIONS + i;
+        ASSERT_MIMPI_OK(MIMPI_Startall(4, requests));
+        ASSERT_MIMPI_OK(MIMPI_Waitall(4, requests));
+        assert(from_left == left * ITERATIONS + i);
+        assert(from_right == right * ITERATIONS + i);
+    }
+
+    // single request started on its own
+    to_right = -world_rank;
+    ASSERT_MIMPI_OK(MIMPI_Start(&requests[0]));
+    ASSERT_MIMPI_OK(MIMPI_Start(&requests[2]));
+    ASSERT_MIMPI_OK(MIMPI_Wait(&requests[2]));
+    ASSERT_MIMPI_OK(MIMPI_Wait(&requests[0]));
+    assert(from_left == -left);
+
+    for (int i = 0; i < 4; i++)
+    {
+        ASSERT_MIMPI_OK(MIMPI_Request_free(&requests[i]));
+        assert(requests[i] == MIMPI_REQUEST_NULL);
+    }
+
+    MIMPI_Finalize();
+    return test_success();
+}
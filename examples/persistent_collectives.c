@@ -0,0 +1,66 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../mimpi.h"
+#include "mimpi_err.h"
+#include "test.h"
+
+#define DATA_LEN 100
+#define ITERATIONS 200
+
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+
+    int const world_rank = MIMPI_World_rank();
+    int const world_size = MIMPI_World_size();
+    int const root = world_size / 2;
+
+    uint8_t bcast_data[DATA_LEN], send_data[DATA_LEN], recv_data[DATA_LEN];
+    MIMPI_Request requests[2];
+    ASSERT_MIMPI_OK(MIMPI_Bcast_init(bcast_data, DATA_LEN, root, &requests[0]));
+    ASSERT_MIMPI_OK(MIMPI_Reduce_init(send_data, recv_data, DATA_LEN, MIMPI_MAX, root, &requests[1]));
+
+    for (int it = 0; it < ITERATIONS; ++it)
+    {
+        for (int k = 0; k < DATA_LEN; ++k)
+        {
+            bcast_data[k] = (world_rank == root ? (uint8_t)(it + k) : 0);
+            send_data[k] = (uint8_t)(world_rank + it % 100);
+        }
+
+        if (it % 2 == 0)
+        {
+            ASSERT_MIMPI_OK(MIMPI_Start(&requests[0]));
+            ASSERT_MIMPI_OK(MIMPI_Wait(&requests[0]));
+            ASSERT_MIMPI_OK(MIMPI_Start(&requests[1]));
+            ASSERT_MIMPI_OK(MIMPI_Wait(&requests[1]));
+        }
+        else
+        {
+            ASSERT_MIMPI_OK(MIMPI_Startall(2, requests));
+            ASSERT_MIMPI_OK(MIMPI_Waitall(2, requests));
+        }
+        test_assert(requests[0] != MIMPI_REQUEST_NULL && requests[1] != MIMPI_REQUEST_NULL);
+
+        for (int k = 0; k < DATA_LEN; ++k)
+        {
+            test_assert(bcast_data[k] == (uint8_t)(it + k));
+            if (world_rank == root)
+                test_assert(recv_data[k] == (uint8_t)(world_size - 1 + it % 100));
+        }
+
+        // blocking collectives in between keep their order
+        ASSERT_MIMPI_OK(MIMPI_Barrier());
+    }
+
+    ASSERT_MIMPI_OK(MIMPI_Request_free(&requests[0]));
+    ASSERT_MIMPI_OK(MIMPI_Request_free(&requests[1]));
+    test_assert(requests[0] == MIMPI_REQUEST_NULL && requests[1] == MIMPI_REQUEST_NULL);
+
+    MIMPI_Finalize();
+    return test_success();
+}
@@ -0,0 +1,121 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../mimpi.h"
+#include "mimpi_err.h"
+#include "test.h"
+
+#define MESSAGES 8
+#define THREADS 2
+#define PROBED 1000
+
+static int received[THREADS];
+
+static void *claimer(void *arg)
+{
+    int id = *(int *)arg;
+    for (int i = 0; i < MESSAGES / THREADS; i++)
+    {
+        MIMPI_Message_handle message;
+        MIMPI_Status status;
+        ASSERT_MIMPI_OK(MIMPI_Mprobe(0, 2, &message, &status));
+        assert(status.source == 0 && status.tag == 2 && status.count == sizeof(int));
+        int value;
+        ASSERT_MIMPI_OK(MIMPI_Mrecv(&value, &message));
+        assert(message == MIMPI_MESSAGE_NULL);
+        received[id] += value;
+    }
+    return NULL;
+}
+
+// looks at messages the main thread receives at the same time
+static void *prober(void *arg)
+{
+    MIMPI_Status status;
+    do
+    {
+        ASSERT_MIMPI_OK(MIMPI_Probe(0, MIMPI_ANY_TAG, &status));
+        assert(status.source == 0);
+        assert((status.tag == 4 && status.count == sizeof(int)) || (status.tag == 5 && status.count == 1));
+    } while (status.tag != 5);
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+
+    int const world_rank = MIMPI_World_rank();
+
+    if (world_rank == 0)
+    {
+        char ready;
+        ASSERT_MIMPI_OK(MIMPI_Recv(&ready, 1, 1, 3));
+        for (int size = 1; size <= 4096; size *= 4)
+        {
+            char *data = malloc(size);
+            for (int i = 0; i < size; i++)
+                data[i] = (char)(i % 101);
+            ASSERT_MIMPI_OK(MIMPI_Send(data, size, 1, 1));
+            free(data);
+        }
+        for (int i = 1; i <= MESSAGES; i++)
+            ASSERT_MIMPI_OK(MIMPI_Send(&i, sizeof(int), 1, 2));
+        for (int i = 0; i < PROBED; i++)
+            ASSERT_MIMPI_OK(MIMPI_Send(&i, sizeof(int), 1, 4));
+        char done = 1;
+        ASSERT_MIMPI_OK(MIMPI_Send(&done, 1, 1, 5));
+    }
+    else if (world_rank == 1)
+    {
+        bool flag;
+        ASSERT_MIMPI_OK(MIMPI_Iprobe(0, 3, &flag, NULL));
+        assert(!flag);
+        char ready = 1;
+        ASSERT_MIMPI_OK(MIMPI_Send(&ready, 1, 0, 3));
+
+        for (int size = 1; size <= 4096; size *= 4)
+        {
+            MIMPI_Status status;
+            ASSERT_MIMPI_OK(MIMPI_Probe(0, MIMPI_ANY_TAG, &status));
+            assert(status.source == 0 && status.tag == 1 && status.count == size);
+            ASSERT_MIMPI_OK(MIMPI_Iprobe(0, 1, &flag, &status));
+            assert(flag && status.count == size);
+
+            char *data = malloc(status.count);
+            ASSERT_MIMPI_OK(MIMPI_Recv(data, status.count, 0, 1));
+            for (int i = 0; i < size; i++)
+                assert(data[i] == (char)(i % 101));
+            free(data);
+        }
+
+        pthread_t threads[THREADS];
+        int ids[THREADS];
+        for (int i = 0; i < THREADS; i++)
+        {
+            ids[i] = i;
+            assert(pthread_create(&threads[i], NULL, claimer, &ids[i]) == 0);
+        }
+        for (int i = 0; i < THREADS; i++)
+            assert(pthread_join(threads[i], NULL) == 0);
+        assert(received[0] + received[1] == MESSAGES * (MESSAGES + 1) / 2);
+
+        pthread_t probing;
+        assert(pthread_create(&probing, NULL, prober, NULL) == 0);
+        for (int i = 0; i < PROBED; i++)
+        {
+            int value;
+            ASSERT_MIMPI_OK(MIMPI_Recv(&value, sizeof(int), 0, 4));
+            assert(value == i);
+        }
+        assert(pthread_join(probing, NULL) == 0);
+        char done;
+        ASSERT_MIMPI_OK(MIMPI_Recv(&done, 1, 0, 5));
+        printf("Process 1 probed and received all messages\n");
+    }
+
+    MIMPI_Finalize();
+    return test_success();
+}
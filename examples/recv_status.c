@@ -0,0 +1,46 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../mimpi.h"
+#include "mimpi_err.h"
+#include "test.h"
+
+#define MAX_SIZE 2000
+
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+
+    int const world_rank = MIMPI_World_rank();
+
+    char data[MAX_SIZE];
+    if (world_rank == 0)
+    {
+        for (int i = 0; i < MAX_SIZE; i++)
+            data[i] = (char)(i % 89);
+        for (int size = 0; size <= MAX_SIZE; size += 250)
+            ASSERT_MIMPI_OK(MIMPI_Send(data, size, 1, 5 + size % 2));
+        ASSERT_MIMPI_OK(MIMPI_Send(data, 100, 1, 7));
+    }
+    else if (world_rank == 1)
+    {
+        for (int size = 0; size <= MAX_SIZE; size += 250)
+        {
+            MIMPI_Status status;
+            ASSERT_MIMPI_OK(MIMPI_Recv_status(data, MAX_SIZE, 0, MIMPI_ANY_TAG, &status));
+            assert(status.source == 0 && status.tag == 5 + size % 2 && status.count == size);
+            for (int i = 0; i < size; i++)
+                assert(data[i] == (char)(i % 89));
+        }
+
+        MIMPI_Status status;
+        data[10] = -1;
+        ASSERT_MIMPI_RETCODE(MIMPI_Recv_status(data, 10, 0, 7, &status), MIMPI_ERROR_TRUNCATED);
+        assert(status.count == 100 && data[9] == 9 && data[10] == -1);
+        printf("Process 1 received all messages\n");
+    }
+
+    MIMPI_Finalize();
+    return test_success();
+}
@@ -0,0 +1,58 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "../mimpi.h"
+#include "mimpi_err.h"
+#include "test.h"
+
+static long elapsed_ms(struct timespec const *since)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - since->tv_sec) * 1000 + (now.tv_nsec - since->tv_nsec) / 1000000;
+}
+
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+
+    int const world_rank = MIMPI_World_rank();
+
+    int number = 0;
+    if (world_rank == 0)
+    {
+        // late message, receiver gives up before it arrives
+        usleep(300000);
+        number = 42;
+        ASSERT_MIMPI_OK(MIMPI_Send(&number, sizeof(int), 1, 2));
+        ASSERT_MIMPI_OK(MIMPI_Recv(NULL, 0, 1, 3));
+        number = 17;
+        ASSERT_MIMPI_OK(MIMPI_Send(&number, sizeof(int), 1, 4));
+    }
+    else if (world_rank == 1)
+    {
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        ASSERT_MIMPI_RETCODE(MIMPI_Recv_timeout(&number, sizeof(int), 0, 2, 50), MIMPI_ERROR_TIMEOUT);
+        assert(elapsed_ms(&start) >= 50);
+
+        // the late message stays queued for later receives
+        ASSERT_MIMPI_OK(MIMPI_Recv(&number, sizeof(int), 0, 2));
+        assert(number == 42);
+
+        // deadline already in the past
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        ASSERT_MIMPI_RETCODE(MIMPI_Recv_deadline(&number, sizeof(int), 0, 4, &start), MIMPI_ERROR_TIMEOUT);
+
+        ASSERT_MIMPI_OK(MIMPI_Send(NULL, 0, 0, 3));
+        ASSERT_MIMPI_OK(MIMPI_Recv_timeout(&number, sizeof(int), 0, 4, 5000));
+        assert(number == 17);
+        printf("Process 1 received all messages\n");
+    }
+
+    MIMPI_Finalize();
+    return test_success();
+}
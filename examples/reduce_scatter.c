@@ -0,0 +1,64 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../mimpi.h"
+#include "mimpi_err.h"
+#include "test.h"
+
+static uint8_t value(int rank, int k) {
+    return rank + 1 + k % 7;
+}
+
+static uint8_t expected(MIMPI_Op op, int world_size, int k) {
+    uint8_t result = value(0, k);
+    for (int r = 1; r < world_size; ++r) {
+        uint8_t const v = value(r, k);
+        if (op == MIMPI_PROD) result *= v;
+        else if (op == MIMPI_SUM) result += v;
+        else if (op == MIMPI_MIN) result = v < result ? v : result;
+        else result = v > result ? v : result;
+    }
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+
+    int const world_rank = MIMPI_World_rank();
+    int const world_size = MIMPI_World_size();
+    int const count = atoi(argv[1]);
+
+    uint8_t *send_data = malloc(3 * count * world_size + 1);
+    uint8_t *recv_data = malloc(3 * count + 1);
+    assert(send_data && recv_data);
+    for (int k = 0; k < 3 * count * world_size; ++k)
+        send_data[k] = value(world_rank, k);
+
+    MIMPI_Op const ops[] = {MIMPI_PROD, MIMPI_SUM, MIMPI_MIN, MIMPI_MAX};
+    for (int i = 0; i < sizeof(ops) / sizeof(MIMPI_Op); ++i) {
+        MIMPI_Op const op = ops[i];
+
+        ASSERT_MIMPI_OK(MIMPI_Reduce_scatter_block(send_data, recv_data, count, op));
+        for (int k = 0; k < count; ++k)
+            test_assert(recv_data[k] == expected(op, world_size, world_rank * count + k));
+
+        int recv_counts[16], offset = 0;
+        for (int r = 0; r < world_size; ++r) {
+            recv_counts[r] = (r % 3 + 1) * count;
+            if (r < world_rank)
+                offset += recv_counts[r];
+        }
+        ASSERT_MIMPI_OK(MIMPI_Reduce_scatter(send_data, recv_data, recv_counts, op));
+        for (int k = 0; k < recv_counts[world_rank]; ++k)
+            test_assert(recv_data[k] == expected(op, world_size, offset + k));
+    }
+
+    free(send_data);
+    free(recv_data);
+    MIMPI_Finalize();
+    return test_success();
+}
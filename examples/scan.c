@@ -0,0 +1,60 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../mimpi.h"
+#include "mimpi_err.h"
+#include "test.h"
+
+static uint8_t value(int rank, int k) {
+    return rank + 1 + k % 5;
+}
+
+// reduction over processes first, ..., last - 1
+static uint8_t expected(MIMPI_Op op, int last, int k) {
+    uint8_t result = value(0, k);
+    for (int r = 1; r < last; ++r) {
+        uint8_t const v = value(r, k);
+        if (op == MIMPI_PROD) result *= v;
+        else if (op == MIMPI_SUM) result += v;
+        else if (op == MIMPI_MIN) result = v < result ? v : result;
+        else result = v > result ? v : result;
+    }
+    return result;
+}
+
+#define DATA_LEN 1000
+
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+
+    int const world_rank = MIMPI_World_rank();
+
+    uint8_t send_data[DATA_LEN], recv_data[DATA_LEN];
+    MIMPI_Op const ops[] = {MIMPI_PROD, MIMPI_SUM, MIMPI_MIN, MIMPI_MAX};
+    for (int i = 0; i < sizeof(ops) / sizeof(MIMPI_Op); ++i) {
+        MIMPI_Op const op = ops[i];
+        for (int k = 0; k < DATA_LEN; ++k)
+            send_data[k] = value(world_rank, k);
+
+        ASSERT_MIMPI_OK(MIMPI_Scan(send_data, recv_data, DATA_LEN, op));
+        for (int k = 0; k < DATA_LEN; ++k)
+            test_assert(recv_data[k] == expected(op, world_rank + 1, k));
+
+        memset(recv_data, 0, DATA_LEN);
+        ASSERT_MIMPI_OK(MIMPI_Exscan(send_data, recv_data, DATA_LEN, op));
+        for (int k = 0; k < DATA_LEN; ++k)
+            test_assert(recv_data[k] == (world_rank == 0 ? 0 : expected(op, world_rank, k)));
+
+        // in place
+        ASSERT_MIMPI_OK(MIMPI_Scan(send_data, send_data, DATA_LEN, op));
+        for (int k = 0; k < DATA_LEN; ++k)
+            test_assert(send_data[k] == expected(op, world_rank + 1, k));
+    }
+
+    MIMPI_Finalize();
+    return test_success();
+}
@@ -0,0 +1,66 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "../mimpi.h"
+#include "mimpi_err.h"
+#include "test.h"
+
+static uint8_t value(int rank, int k) {
+    return (uint8_t)(rank * 31 + k);
+}
+
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+
+    int const world_rank = MIMPI_World_rank();
+    int const world_size = MIMPI_World_size();
+    int const count = atoi(argv[1]);
+
+    uint8_t *send_data = malloc(count * world_size * world_size + 1);
+    uint8_t *recv_data = malloc(count * world_size + 1);
+    assert(send_data && recv_data);
+
+    for (int root = 0; root < world_size; ++root)
+    {
+        if (world_rank == root)
+            for (int r = 0; r < world_size; ++r)
+                for (int k = 0; k < count; ++k)
+                    send_data[r * count + k] = value(r, k);
+        memset(recv_data, 0, count);
+        ASSERT_MIMPI_OK(MIMPI_Scatter(send_data, recv_data, count, root));
+        for (int k = 0; k < count; ++k)
+            test_assert(recv_data[k] == value(world_rank, k));
+    }
+
+    // process r gets r * count bytes, stored in reverse rank order
+    int send_counts[16], displs[16];
+    int total = 0;
+    for (int r = world_size - 1; r >= 0; --r)
+    {
+        send_counts[r] = r * count;
+        displs[r] = total;
+        for (int k = 0; k < send_counts[r]; ++k)
+            send_data[total + k] = value(r, k);
+        total += send_counts[r];
+    }
+    int const root = world_size / 2;
+    memset(recv_data, 0, count * world_size);
+    ASSERT_MIMPI_OK(MIMPI_Scatterv(send_data, send_counts, displs, recv_data, world_rank * count, root));
+    for (int k = 0; k < world_rank * count; ++k)
+        test_assert(recv_data[k] == value(world_rank, k));
+
+    if (world_size > 1 && count > 0)
+    {
+        int const retcode = MIMPI_Scatterv(send_data, send_counts, displs, recv_data, count / 2, root);
+        test_assert(retcode == (world_rank > 0 ? MIMPI_ERROR_TRUNCATED : MIMPI_SUCCESS));
+    }
+
+    free(send_data);
+    free(recv_data);
+    MIMPI_Finalize();
+    return test_success();
+}
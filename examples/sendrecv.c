@@ -0,0 +1,47 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "../mimpi.h"
+#include "mimpi_err.h"
+#include "test.h"
+
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+
+    int const world_rank = MIMPI_World_rank();
+    int const world_size = MIMPI_World_size();
+
+    assert(argc >= 2);
+    int const size = atoi(argv[1]);
+
+    int const right = (world_rank + 1) % world_size;
+    int const left = (world_rank + world_size - 1) % world_size;
+
+    char *send_data = malloc(size);
+    char *recv_data = malloc(size);
+    assert(send_data && recv_data);
+    for (int i = 0; i < size; i++)
+        send_data[i] = (char)(world_rank * 7 + i);
+
+    // everybody sends first, which must not block the exchange
+    ASSERT_MIMPI_OK(MIMPI_Sendrecv(send_data, size, right, 1, recv_data, size, left, 1));
+    for (int i = 0; i < size; i++)
+        assert(recv_data[i] == (char)(left * 7 + i));
+
+    ASSERT_MIMPI_OK(MIMPI_Sendrecv_replace(send_data, size, left, 2, right, 2));
+    for (int i = 0; i < size; i++)
+        assert(send_data[i] == (char)(right * 7 + i));
+
+    ASSERT_MIMPI_RETCODE(
+        MIMPI_Sendrecv(send_data, size, world_rank, 1, recv_data, size, left, 1),
+        MIMPI_ERROR_ATTEMPTED_SELF_OP
+    );
+
+    free(send_data);
+    free(recv_data);
+
+    MIMPI_Finalize();
+    return test_success();
+}
@@ -0,0 +1,49 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../mimpi.h"
+#include "mimpi_err.h"
+#include "test.h"
+
+// every stride-th byte, shifted by rank, is nonzero
+static char value(int rank, int k, int stride) {
+    return (k + rank) % stride == 0 ? rank % 5 - 2 + (rank % 5 >= 2) : 0;
+}
+
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+
+    int const world_rank = MIMPI_World_rank();
+    int const data_len = atoi(argv[1]);
+    int const stride = atoi(argv[2]);
+
+    char *send_data = malloc(data_len);
+    char *recv_data = malloc(data_len);
+    char *expected = malloc(data_len);
+    assert(send_data && recv_data && expected);
+
+    MIMPI_Op const ops[] = {MIMPI_PROD, MIMPI_SUM, MIMPI_MIN, MIMPI_MAX};
+    for (int i = 0; i < sizeof(ops) / sizeof(MIMPI_Op); ++i) {
+        MIMPI_Op const op = ops[i];
+        for (int k = 0; k < data_len; ++k)
+            send_data[k] = value(world_rank, k, stride);
+        memset(recv_data, 7, data_len);
+
+        ASSERT_MIMPI_OK(MIMPI_Allreduce(send_data, expected, data_len, op));
+        // second time in place
+        ASSERT_MIMPI_OK(MIMPI_Sparse_allreduce(send_data, recv_data, data_len, op));
+        ASSERT_MIMPI_OK(MIMPI_Sparse_allreduce(send_data, send_data, data_len, op));
+
+        test_assert(memcmp(recv_data, expected, data_len) == 0);
+        test_assert(memcmp(send_data, expected, data_len) == 0);
+    }
+
+    free(send_data);
+    free(recv_data);
+    free(expected);
+    MIMPI_Finalize();
+    return test_success();
+}
@@ -0,0 +1,31 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include "../mimpi.h"
+#include "mimpi_err.h"
+#include "test.h"
+
+int main(int argc, char **argv)
+{
+    MIMPI_Init(false);
+    int const process_rank = MIMPI_World_rank();
+    int const size_of_cluster = MIMPI_World_size();
+
+    volatile unsigned work = 0;
+    for (int i = 0; i < size_of_cluster; i++)
+    {
+        if (i == process_rank)
+        {
+            printf("Hello World from process %d of %d\n", process_rank, size_of_cluster);
+            fflush(stdout);
+        }
+        ASSERT_MIMPI_OK(MIMPI_Barrier_begin());
+        // independent work while the others arrive
+        for (unsigned k = 0; k < 100000; k++)
+            work += k * (unsigned)process_rank;
+        ASSERT_MIMPI_OK(MIMPI_Barrier_end());
+    }
+    ASSERT_MIMPI_OK(MIMPI_Barrier_end());
+
+    MIMPI_Finalize();
+    return test_success();
+}
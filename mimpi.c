@@ -5,8 +5,10 @@
 #include "channel.h"
 #include "mimpi.h"
 #include "mimpi_common.h"
+#include <errno.h>
 #include <pthread.h>
 #include <sys/param.h>
+#include <sys/uio.h>
 #include <stdatomic.h>
 
 #define MIMPI_CHANNEL_BUF 512
@@ -19,18 +21,58 @@
 #define RECV_ASK -4
 #define RECV_ANS -5
 #define RECEIVED -6
+// neighbour collectives, one tag for each neighbour slot of a Cartesian topology
+#define NEIGHBOR_TAG(slot) (-64 - (slot))
+#define NEIGHBOR_SLOTS 64
+// "tree" or "dissemination", the algorithm of MIMPI_Barrier until one is set
+#define MIMPI_BARRIER_VAR "MIMPI_BARRIER"
+// fixed size of broadcast segments in bytes, instead of one depending on data size
+#define MIMPI_BCAST_SEGMENT_VAR "MIMPI_BCAST_SEGMENT"
+#define MIMPI_REDUCE_SEGMENT_VAR "MIMPI_REDUCE_SEGMENT"
+// size in bytes from which reduce uses Rabenseifner's algorithm, never if unset
+#define MIMPI_REDUCE_RABENSEIFNER_VAR "MIMPI_REDUCE_RABENSEIFNER"
+
+// metadata sent before every message's data
+typedef struct MIMPI_Header MIMPI_Header;
+struct MIMPI_Header {
+    int tag, count;
+    int part; // 1 + index of the partition of a partitioned send, 0 for other messages
+    int context; // of the communicator, 0 for the world
+};
 
 struct MIMPI_Message{
-    int source, tag, count;
+    int source, tag, count, part, context;
+    bool claimed; // some receive has already taken this message
     pthread_mutex_t is_buffered; // mutex to wait if the message is still being buffered
     void *buffer; // pointer to where the received data is stored
 };
 typedef struct MIMPI_Message MIMPI_Message;
 
+#define MIMPI_ANY_COUNT -1 // pattern count matching messages of any size
+
+// from this many bytes on allreduce goes around a ring instead of the tree
+#define ALLREDUCE_RING_THRESHOLD 16384
+// from this many bytes gathered in total allgather goes around a ring instead of Bruck's
+#define ALLGATHER_RING_THRESHOLD 16384
+// blocks of alltoall shorter than this go with Bruck's algorithm, longer are exchanged pairwise
+#define ALLTOALL_BRUCK_THRESHOLD 256
+// sparse allreduce sends index/value pairs only while they take less space than the whole vector
+#define SPARSE_ENTRY_SIZE ((int)sizeof(int) + 1)
+// broadcast and reduce data of this many bytes move along the tree in about
+// PIPELINE_SEGMENTS segments of at least PIPELINE_MIN_SEGMENT bytes,
+// each passed on as soon as it arrives
+#define PIPELINE_THRESHOLD 16384
+#define PIPELINE_SEGMENTS 16
+#define PIPELINE_MIN_SEGMENT 4096
+// from this many bytes on broadcast scatters data in blocks, which then go around a ring
+#define BCAST_SCATTER_THRESHOLD (1 << 20)
+
 inline static bool match(MIMPI_Message *a, MIMPI_Message *b) {
     return (((a->tag == 0 && b->tag > 0) || a->tag == b->tag) 
          && a->source == b->source 
-         && a->count == b->count);
+         && a->part == b->part
+         && a->context == b->context
+         && (a->count == MIMPI_ANY_COUNT || a->count == b->count));
 }
 
 typedef struct MIMPI_Node MIMPI_Node;
@@ -43,6 +85,7 @@ inline static MIMPI_Node* new_MIMPI_Node() {
     MIMPI_Node *node = malloc(sizeof(MIMPI_Node));
     ASSERT_NOT_NULL(node);
     ASSERT_NOT_NULL(node->msg = malloc(sizeof(MIMPI_Message)));
+    node->msg->claimed = false;
 
     pthread_mutexattr_t attr;
     ASSERT_ZERO(pthread_mutexattr_init(&attr));
@@ -69,6 +112,76 @@ struct MIMPI_Queue {
     MIMPI_Node *begin, *end;
 };
 
+// a receive (or probe) waiting for a message that hasn't arrived yet,
+// matched by the receiver threads as soon as the message's metadata is read
+typedef struct MIMPI_Waiter MIMPI_Waiter;
+struct MIMPI_Waiter {
+    MIMPI_Message *pattern;
+    bool claim; // take the message (receive) or only look at it (probe)
+    MIMPI_Node *found; // not to be dereferenced when claim isn't set, a receive may free it
+    MIMPI_Status seen; // of the found message, filled under queue.mutex
+    MIMPI_Waiter *prev, *next;
+};
+
+typedef enum {
+    MIMPI_REQUEST_SEND,
+    MIMPI_REQUEST_RECV,
+    MIMPI_REQUEST_PSEND,
+    MIMPI_REQUEST_PRECV,
+    MIMPI_REQUEST_COLL,
+} MIMPI_Request_kind;
+
+typedef enum {
+    MIMPI_COLL_BARRIER,
+    MIMPI_COLL_BCAST,
+    MIMPI_COLL_REDUCE,
+} MIMPI_Collective;
+
+// neighbours of a process in the tree of a collective, as world ranks
+typedef struct {
+    int parent; // -1 for the root
+    int children[2];
+    int child_count;
+    int context; // of the communicator the collective runs in
+} MIMPI_Tree;
+
+// everything an operation needs precomputed once, so that starting it
+// again only moves the data
+struct MIMPI_Request_data {
+    MIMPI_Request_kind kind;
+    bool active; // started and not waited for yet
+    MIMPI_Retcode result;
+    void *data;
+    int peer;
+    MIMPI_Header header; // send
+    MIMPI_Message pattern; // receive
+    MIMPI_Waiter waiter; // receive
+
+    // partitioned send and receive, count is the size of one partition
+    int partitions, count;
+    int done; // partitions sent, guarded by mutex
+    pthread_mutex_t mutex;
+    pthread_cond_t all_done;
+    MIMPI_Message *patterns; // receive, one per partition
+    MIMPI_Waiter *waiters;
+    bool *arrived; // receive, partitions already copied to data
+
+    // collective, performed by the collective progress thread
+    MIMPI_Collective collective;
+    void const *send_data;
+    int root;
+    MIMPI_Op op;
+    bool finished; // guarded by coll.mutex
+    MIMPI_Request next_queued; // guarded by coll.mutex
+    bool persistent; // started with MIMPI_Start, kept by MIMPI_Wait
+    MIMPI_Tree tree; // persistent
+    char *scratch; // persistent reduce, see MIMPI_tree_reduce
+};
+
+inline static bool MIMPI_is_receive(MIMPI_Request req) {
+    return (req->kind == MIMPI_REQUEST_RECV || req->kind == MIMPI_REQUEST_PRECV);
+}
+
 
 #define ASSERT_MIMPI_RECV_OK(expr)              \
     if (expr == MIMPI_ERROR_REMOTE_FINISHED)    \
@@ -76,18 +189,108 @@ struct MIMPI_Queue {
 
 
 static MIMPI_Queue queue;
-static MIMPI_Message *msg_pattern = NULL; // message we are waiting for
-static atomic_bool found_matching_msg = true;
+static MIMPI_Waiter waiters; // dummy head of a cyclic list, guarded by queue.mutex
 static pthread_cond_t matched_msg;
 
+// a buffered send waiting in the attached buffer, followed by its data
+typedef struct MIMPI_Buffered MIMPI_Buffered;
+struct MIMPI_Buffered {
+    int destination; // -1 marks unused space until the end of the buffer
+    int size; // bytes taken in the buffer, together with this metadata
+    MIMPI_Header header;
+};
+
+// state of buffered sends, guarded by its mutex
+static struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;
+    pthread_t thread; // writes out the buffered messages
+    bool attached, detaching;
+    char *data;
+    int capacity;
+    int head, tail; // oldest message and where the next one goes
+    int used; // bytes taken, together with a skipped end of the buffer
+    int messages;
+    int *pending; // number of messages waiting for each destination
+    int peak_used, overflows, failed;
+} bsend;
+
+// group of processes with its own space of messages
+struct MIMPI_Comm_data {
+    int context; // sent in headers of all messages within the communicator
+    int size, rank;
+    int *ranks; // world rank of every member
+};
+
+static struct MIMPI_Comm_data world_comm;
+static int next_context = 1; // lowest context this process hasn't used yet
+
+inline static MIMPI_Comm MIMPI_comm(MIMPI_Comm comm) {
+    return (comm == MIMPI_COMM_WORLD ? &world_comm : comm);
+}
+
+// neighbours of this process in a process topology
+struct MIMPI_Topology_data {
+    int ndims; // 0 for a graph
+    int *dims;
+    bool *periods;
+    int indegree, outdegree;
+    int *sources, *destinations; // MIMPI_PROC_NULL past a Cartesian grid's edge
+    int *recv_tags, *send_tags; // tag of the message from/to each neighbour
+};
+
+// state of nonblocking collectives, guarded by its mutex
+static struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;
+    pthread_t thread; // performs the queued collectives one by one
+    bool started, stopping;
+    MIMPI_Request head, tail; // queue of collectives not finished yet
+} coll;
+
+static MIMPI_Request split_barrier = MIMPI_REQUEST_NULL; // between MIMPI_Barrier_begin and _end
+
 static int world_size, my_rank;
 static int *write_fd, *read_fd;
 static pthread_t threads[16];
+static pthread_mutex_t send_mutex[16]; // one message written at a time to each process
 static bool left_MIMPI_block[16];
-static bool group_failed = false; // doesnt need to be atomic
+static bool group_failed = false; // of world collectives, doesnt need to be atomic
+static double alltoall_step_times[16]; // in seconds, of the last alltoall
+static int alltoall_steps = 0;
+static MIMPI_Barrier_algorithm barrier_algorithm = MIMPI_BARRIER_TREE;
+static int bcast_segment = 0; // 0 when it depends on data size
+static int reduce_segment = 0;
+static int reduce_rabenseifner = 0; // 0 when reduce always goes down the tree
+
+
+inline static void MIMPI_fill_status(MIMPI_Status *status, MIMPI_Message *msg) {
+    if (status != NULL) {
+        *status = (MIMPI_Status) {.source = msg->source, .tag = msg->tag, .count = msg->count};
+    }
+}
 
+// hands a freshly queued message to the oldest waiter looking for it,
+// has to be called with queue.mutex locked
+static void MIMPI_match_waiters(MIMPI_Node *node) {
+    bool matched = false;
+    for (MIMPI_Waiter *w = waiters.next; w != &waiters; w = w->next) {
+        if (w->found == NULL && match(w->pattern, node->msg)) {
+            w->found = node;
+            MIMPI_fill_status(&w->seen, node->msg);
+            matched = true;
+            if (w->claim) {
+                node->msg->claimed = true;
+                break;
+            }
+        }
+    }
+    if (matched) {
+        ASSERT_ZERO(pthread_cond_broadcast(&matched_msg));
+    }
+}
 
-// msg metadata - tag 4B, count 4B
+// msg metadata - MIMPI_Header
 static void* MIMPI_Receiver(void* receiving_from) {
 
     int *result = malloc(sizeof(int));
@@ -97,30 +300,33 @@ static void* MIMPI_Receiver(void* receiving_from) {
     int proc = *(int*)(receiving_from);
     free(receiving_from);
 
-    const int meta_size = sizeof(int)*2;
-    int meta_buf[2];
+    MIMPI_Header header;
 
     while (1) {
         // read metadata before reading data - tag and count
-        ssize_t read_len = chrecv(read_fd[proc], meta_buf, meta_size);
+        ssize_t read_len = chrecv(read_fd[proc], &header, sizeof(MIMPI_Header));
         if (read_len == 0) {
             return result;    
         }
 
-        int tag = meta_buf[0];
+        int tag = header.tag;
         if (tag < 0) {
             if (tag == -1) {
                 return result;
             }
             else if (tag == -7) {
+                ASSERT_ZERO(pthread_mutex_lock(&queue.mutex));
                 left_MIMPI_block[proc] = 1;
-                ASSERT_ZERO(pthread_cond_signal(&matched_msg));
+                ASSERT_ZERO(pthread_cond_broadcast(&matched_msg));
+                ASSERT_ZERO(pthread_mutex_unlock(&queue.mutex));
                 continue;
             }
             else if (tag == GROUP_FAIL) {
                 if (!group_failed) {
+                    ASSERT_ZERO(pthread_mutex_lock(&queue.mutex));
                     group_failed = true;
-                    ASSERT_ZERO(pthread_cond_signal(&matched_msg));
+                    ASSERT_ZERO(pthread_cond_broadcast(&matched_msg));
+                    ASSERT_ZERO(pthread_mutex_unlock(&queue.mutex));
                     const int l_child = (my_rank*2)-1;
                     const int r_child = l_child+1;
                     if (l_child < world_size) {
@@ -142,8 +348,10 @@ static void* MIMPI_Receiver(void* receiving_from) {
 
         // fill out message metadata
         new_msg->source = proc;
-        new_msg->tag = meta_buf[0];
-        new_msg->count = meta_buf[1];
+        new_msg->tag = header.tag;
+        new_msg->count = header.count;
+        new_msg->part = header.part;
+        new_msg->context = header.context;
 
         // add node to queue
         ASSERT_ZERO(pthread_mutex_lock(&queue.mutex));
@@ -151,13 +359,9 @@ static void* MIMPI_Receiver(void* receiving_from) {
         new_node->prev = queue.end->prev;
         queue.end->prev = new_node;
         new_node->next = queue.end;
+        MIMPI_match_waiters(new_node);
         ASSERT_ZERO(pthread_mutex_unlock(&queue.mutex));
 
-        if (!found_matching_msg && match(msg_pattern, new_msg)) {
-            found_matching_msg = true;
-            ASSERT_ZERO(pthread_cond_signal(&matched_msg));
-        }
-
         // allocate space for the message
         ASSERT_NOT_NULL(new_msg->buffer = malloc(new_msg->count));
 
@@ -194,6 +398,23 @@ void MIMPI_Init(bool enable_deadlock_detection) {
     ASSERT_NOT_NULL(tmp = getenv(MIMPI_RANK_VAR));
     my_rank = atoi(tmp);
 
+    tmp = getenv(MIMPI_BARRIER_VAR);
+    if (tmp != NULL && strcmp(tmp, "dissemination") == 0) {
+        barrier_algorithm = MIMPI_BARRIER_DISSEMINATION;
+    }
+    tmp = getenv(MIMPI_BCAST_SEGMENT_VAR);
+    if (tmp != NULL && atoi(tmp) > 0) {
+        bcast_segment = atoi(tmp);
+    }
+    tmp = getenv(MIMPI_REDUCE_SEGMENT_VAR);
+    if (tmp != NULL && atoi(tmp) > 0) {
+        reduce_segment = atoi(tmp);
+    }
+    tmp = getenv(MIMPI_REDUCE_RABENSEIFNER_VAR);
+    if (tmp != NULL && atoi(tmp) > 0) {
+        reduce_rabenseifner = atoi(tmp);
+    }
+
     ASSERT_NOT_NULL(write_fd = malloc(world_size*sizeof(int)));
     ASSERT_NOT_NULL(read_fd = malloc(world_size*sizeof(int)));
     for (int i = 0; i < world_size; i++) {
@@ -233,7 +454,29 @@ void MIMPI_Init(bool enable_deadlock_detection) {
     ASSERT_ZERO(pthread_mutex_init(&queue.mutex, &mutex_attr));
     ASSERT_ZERO(pthread_mutexattr_destroy(&mutex_attr));
 
-    ASSERT_ZERO(pthread_cond_init(&matched_msg, NULL));
+    // monotonic, so that receive deadlines don't move with the wall clock
+    pthread_condattr_t cond_attr;
+    ASSERT_ZERO(pthread_condattr_init(&cond_attr));
+    ASSERT_ZERO(pthread_condattr_setclock(&cond_attr, CLOCK_MONOTONIC));
+    ASSERT_ZERO(pthread_cond_init(&matched_msg, &cond_attr));
+    ASSERT_ZERO(pthread_condattr_destroy(&cond_attr));
+    waiters.prev = waiters.next = &waiters;
+
+    for (int i = 0; i < world_size; i++) {
+        ASSERT_ZERO(pthread_mutex_init(&send_mutex[i], NULL));
+    }
+    ASSERT_ZERO(pthread_mutex_init(&bsend.mutex, NULL));
+    ASSERT_ZERO(pthread_cond_init(&bsend.changed, NULL));
+    ASSERT_ZERO(pthread_mutex_init(&coll.mutex, NULL));
+    ASSERT_ZERO(pthread_cond_init(&coll.changed, NULL));
+
+    world_comm.context = 0;
+    world_comm.size = world_size;
+    world_comm.rank = my_rank;
+    ASSERT_NOT_NULL(world_comm.ranks = malloc(world_size * sizeof(int)));
+    for (int i = 0; i < world_size; i++) {
+        world_comm.ranks[i] = i;
+    }
 
     pthread_attr_t attr;
     ASSERT_ZERO(pthread_attr_init(&attr));
@@ -251,6 +494,22 @@ void MIMPI_Init(bool enable_deadlock_detection) {
 }
 
 void MIMPI_Finalize() {
+    // let the queued collectives finish
+    if (coll.started) {
+        ASSERT_ZERO(pthread_mutex_lock(&coll.mutex));
+        coll.stopping = true;
+        ASSERT_ZERO(pthread_cond_broadcast(&coll.changed));
+        ASSERT_ZERO(pthread_mutex_unlock(&coll.mutex));
+        ASSERT_ZERO(pthread_join(coll.thread, NULL));
+    }
+
+    // let the buffered sends reach their destinations
+    if (bsend.attached) {
+        void *buffer;
+        int size;
+        MIMPI_Buffer_detach(&buffer, &size);
+    }
+
     // ping everyone else's threads that I'm leaving
     for (int i = 0; i < world_size; i++) {
         if (i == my_rank) {continue;}
@@ -319,6 +578,7 @@ void MIMPI_Finalize() {
 
     free(read_fd);
     free(write_fd);
+    free(world_comm.ranks);
 
     // destroy queue
     // destroy queue mutex
@@ -333,6 +593,14 @@ void MIMPI_Finalize() {
 
     ASSERT_ZERO(pthread_cond_destroy(&matched_msg));
 
+    for (int i = 0; i < world_size; i++) {
+        ASSERT_ZERO(pthread_mutex_destroy(&send_mutex[i]));
+    }
+    ASSERT_ZERO(pthread_mutex_destroy(&bsend.mutex));
+    ASSERT_ZERO(pthread_cond_destroy(&bsend.changed));
+    ASSERT_ZERO(pthread_mutex_destroy(&coll.mutex));
+    ASSERT_ZERO(pthread_cond_destroy(&coll.changed));
+
     channels_finalize();
 }
 
@@ -344,278 +612,3288 @@ int MIMPI_World_rank() {
     return my_rank;
 }
 
-MIMPI_Retcode MIMPI_Send(
-    void const *data,
-    int count,
+// contiguous piece of a datatype, relative to the start of its element
+typedef struct MIMPI_Segment MIMPI_Segment;
+struct MIMPI_Segment {
+    ptrdiff_t offset;
+    int length;
+};
+
+struct MIMPI_Datatype_data {
+    int size; // bytes of data in one element
+    ptrdiff_t extent; // distance between consecutive elements
+    int segments;
+    MIMPI_Segment *segment; // sorted by position in the packed data
+    ptrdiff_t stride; // if not 0, all segments are equally long and this far apart
+};
+
+static MIMPI_Segment byte_segment = {.offset = 0, .length = 1};
+static struct MIMPI_Datatype_data byte_type = {
+    .size = 1, .extent = 1, .segments = 1, .segment = &byte_segment, .stride = 0
+};
+
+inline static MIMPI_Datatype MIMPI_type(MIMPI_Datatype type) {
+    return (type == MIMPI_BYTE ? &byte_type : type);
+}
+
+// walks over the data of a message laid out in pieces: either
+// a vector of buffers, or count consecutive elements of type at base
+typedef struct MIMPI_Cursor MIMPI_Cursor;
+struct MIMPI_Cursor {
+    const struct iovec *iov;
+    int iovcnt;
+    char *base;
+    MIMPI_Datatype type;
+    int count;
+    int piece; // current piece
+    int pos; // bytes of the current piece already walked over
+};
+
+inline static MIMPI_Cursor MIMPI_iov_cursor(const struct iovec *iov, int iovcnt) {
+    return (MIMPI_Cursor) {.iov = iov, .iovcnt = iovcnt};
+}
+
+inline static MIMPI_Cursor MIMPI_type_cursor(void const *base, int count, MIMPI_Datatype type) {
+    return (MIMPI_Cursor) {.base = (char*)base, .type = MIMPI_type(type), .count = count};
+}
+
+// returns the current piece and its length, or NULL after the last one
+inline static char* MIMPI_cursor_piece(MIMPI_Cursor *c, int *length) {
+    if (c->iov != NULL) {
+        if (c->piece >= c->iovcnt) {
+            return NULL;
+        }
+        *length = c->iov[c->piece].iov_len;
+        return c->iov[c->piece].iov_base;
+    }
+    if (c->piece >= c->count * c->type->segments) {
+        return NULL;
+    }
+    const int element = c->piece / c->type->segments;
+    MIMPI_Segment *seg = &c->type->segment[c->piece % c->type->segments];
+    *length = seg->length;
+    return c->base + element * c->type->extent + seg->offset;
+}
+
+inline static void MIMPI_cursor_advance(MIMPI_Cursor *c, int n, int length) {
+    c->pos += n;
+    if (c->pos == length) {
+        c->piece++;
+        c->pos = 0;
+    }
+}
+
+// Copies n equally long blocks between packed, where they are one after
+// another, and strided, where they are stride bytes apart. Common block
+// sizes get their own loops, so that the copies are done with single
+// (vectorised) moves instead of calls to memcpy.
+static void MIMPI_strided_copy(char *packed, char *strided, int n, int length, 
+                               ptrdiff_t stride, bool pack) {
+    #define MIMPI_STRIDED_LOOP(len)                                             \
+        if (pack)                                                               \
+            for (int i = 0; i < n; i++)                                         \
+                memcpy(packed + (ptrdiff_t)i*(len), strided + i*stride, (len)); \
+        else                                                                    \
+            for (int i = 0; i < n; i++)                                         \
+                memcpy(strided + i*stride, packed + (ptrdiff_t)i*(len), (len));
+    switch (length) {
+        case 1: MIMPI_STRIDED_LOOP(1); break;
+        case 2: MIMPI_STRIDED_LOOP(2); break;
+        case 4: MIMPI_STRIDED_LOOP(4); break;
+        case 8: MIMPI_STRIDED_LOOP(8); break;
+        case 16: MIMPI_STRIDED_LOOP(16); break;
+        default: MIMPI_STRIDED_LOOP(length); break;
+    }
+    #undef MIMPI_STRIDED_LOOP
+}
+
+// copies the next n bytes walked over by c to (gather) or from (scatter) packed
+static void MIMPI_cursor_copy(MIMPI_Cursor *c, char *packed, int n, bool gather) {
+    while (n > 0) {
+        // whole equally spaced segments of the current element at once
+        if (c->type != NULL && c->type->stride != 0 && c->pos == 0) {
+            const int length = c->type->segment[0].length;
+            const int seg = c->piece % c->type->segments;
+            const int blocks = MIN(c->type->segments - seg, n / length);
+            if (blocks > 1) {
+                int piece_len;
+                char *piece = MIMPI_cursor_piece(c, &piece_len);
+                MIMPI_strided_copy(packed, piece, blocks, length, c->type->stride, gather);
+                packed += blocks * length;
+                n -= blocks * length;
+                c->piece += blocks;
+                continue;
+            }
+        }
+
+        int length;
+        char *piece = MIMPI_cursor_piece(c, &length);
+        const int copied = MIN(n, length - c->pos);
+        if (gather) {
+            memcpy(packed, piece + c->pos, copied);
+        } else {
+            memcpy(piece + c->pos, packed, copied);
+        }
+        packed += copied;
+        n -= copied;
+        MIMPI_cursor_advance(c, copied, length);
+    }
+}
+
+// writes header followed by its data to an already validated destination
+static MIMPI_Retcode MIMPI_write_message(
     int destination,
-    int tag
+    MIMPI_Header const *header,
+    void const *data
 ) {
-    if (my_rank == destination) 
-        {return MIMPI_ERROR_ATTEMPTED_SELF_OP;}
-    if (destination < 0 || destination >= world_size) 
-        {return MIMPI_ERROR_NO_SUCH_RANK;}
-
-    // first send metadata
-    const int meta_size = sizeof(int)*2;
-    char buffer[MIMPI_CHANNEL_BUF];// = {tag, count};
-    int *buf_ptr = (int*)buffer;
-    *buf_ptr = tag;
-    buf_ptr = (int*)(buffer+sizeof(int));
-    *buf_ptr = count;
+    // first send metadata, together with as much data as fits
+    const int meta_size = sizeof(MIMPI_Header);
+    const int count = header->count;
+    char buffer[MIMPI_CHANNEL_BUF];
+    memcpy(buffer, header, meta_size);
 
     if (count > 0) {
         memcpy(buffer+meta_size, data, MIN(count, MIMPI_CHANNEL_BUF-meta_size));
     }
 
-    int res = chsend(write_fd[destination], buffer, 
-                     MIN(MIMPI_CHANNEL_BUF, count+meta_size));
+    MIMPI_Retcode res = MIMPI_SUCCESS;
+    ASSERT_ZERO(pthread_mutex_lock(&send_mutex[destination]));
+    int sent = chsend(write_fd[destination], buffer, 
+                      MIN(MIMPI_CHANNEL_BUF, count+meta_size));
 
     // pipe closed, destination process has ended ? something broke ?
-    if (res == -1) {
-        return MIMPI_ERROR_REMOTE_FINISHED;
+    if (sent == -1) {
+        res = MIMPI_ERROR_REMOTE_FINISHED;
     }
     
-    int total_sent = res-meta_size;
-    while (count - total_sent) {
+    int total_sent = sent-meta_size;
+    while (res == MIMPI_SUCCESS && count - total_sent) {
         int bytes_sent = chsend(write_fd[destination], data+total_sent, 
                                 MIN(MIMPI_CHANNEL_BUF, count-total_sent));
         if (bytes_sent == -1) {
-            return MIMPI_ERROR_REMOTE_FINISHED;
+            res = MIMPI_ERROR_REMOTE_FINISHED;
         }
         total_sent += bytes_sent;
     }
+    ASSERT_ZERO(pthread_mutex_unlock(&send_mutex[destination]));
 
-    return MIMPI_SUCCESS;
+    return res;
 }
 
-MIMPI_Retcode MIMPI_Recv(
-    void *data,
+// waits until all buffered sends to destination have been written,
+// so that a later message can't overtake them
+static void MIMPI_bsend_flush(int destination) {
+    if (!bsend.attached) {
+        return;
+    }
+    ASSERT_ZERO(pthread_mutex_lock(&bsend.mutex));
+    while (bsend.pending[destination] > 0) {
+        ASSERT_ZERO(pthread_cond_wait(&bsend.changed, &bsend.mutex));
+    }
+    ASSERT_ZERO(pthread_mutex_unlock(&bsend.mutex));
+}
+
+// sends header followed by its data to an already validated destination
+static MIMPI_Retcode MIMPI_send_message(
+    int destination,
+    MIMPI_Header const *header,
+    void const *data
+) {
+    MIMPI_bsend_flush(destination);
+    return MIMPI_write_message(destination, header, data);
+}
+
+// Sends header followed by the data walked over by c. Pieces spanning
+// a whole channel write are written directly, smaller ones are gathered
+// straight into the write buffer.
+static MIMPI_Retcode MIMPI_send_gathered(
+    int destination,
+    MIMPI_Header const *header,
+    MIMPI_Cursor *c
+) {
+    MIMPI_bsend_flush(destination);
+
+    const int meta_size = sizeof(MIMPI_Header);
+    char buffer[MIMPI_CHANNEL_BUF];
+    memcpy(buffer, header, meta_size);
+
+    int chunk = MIN(header->count, MIMPI_CHANNEL_BUF-meta_size);
+    MIMPI_cursor_copy(c, buffer+meta_size, chunk, true);
+    chunk += meta_size;
+    int bytes_left = header->count + meta_size;
+
+    MIMPI_Retcode res = MIMPI_SUCCESS;
+    ASSERT_ZERO(pthread_mutex_lock(&send_mutex[destination]));
+    char *buf_ptr = buffer;
+    while (bytes_left) {
+        int bytes_sent = chsend(write_fd[destination], buf_ptr, chunk);
+        if (bytes_sent == -1) {
+            res = MIMPI_ERROR_REMOTE_FINISHED;
+            break;
+        }
+        bytes_left -= bytes_sent;
+        chunk -= bytes_sent;
+        buf_ptr += bytes_sent;
+        if (chunk > 0 || bytes_left == 0) {
+            continue;
+        }
+
+        int length;
+        char *piece = MIMPI_cursor_piece(c, &length);
+        if (length - c->pos >= MIN(bytes_left, MIMPI_CHANNEL_BUF)) {
+            chunk = MIN(bytes_left, MIMPI_CHANNEL_BUF);
+            buf_ptr = piece + c->pos;
+            MIMPI_cursor_advance(c, chunk, length);
+        }
+        else {
+            chunk = MIN(bytes_left, MIMPI_CHANNEL_BUF);
+            MIMPI_cursor_copy(c, buffer, chunk, true);
+            buf_ptr = buffer;
+        }
+    }
+    ASSERT_ZERO(pthread_mutex_unlock(&send_mutex[destination]));
+
+    return res;
+}
+
+// sends within the communicator with the given context, to a world rank
+static MIMPI_Retcode MIMPI_send_in(
+    int context,
+    void const *data,
     int count,
-    int source,
+    int destination,
     int tag
 ) {
-    if (my_rank == source) 
+    MIMPI_Header header = {.tag = tag, .count = count, .context = context};
+    return MIMPI_send_message(destination, &header, data);
+}
+
+MIMPI_Retcode MIMPI_Send(
+    void const *data,
+    int count,
+    int destination,
+    int tag
+) {
+    if (my_rank == destination) 
         {return MIMPI_ERROR_ATTEMPTED_SELF_OP;}
-    if (source < 0 || source >= world_size) 
+    if (destination < 0 || destination >= world_size) 
         {return MIMPI_ERROR_NO_SUCH_RANK;}
 
-    found_matching_msg = true;
-    MIMPI_Message *pattern = malloc(sizeof(MIMPI_Message));
-    *pattern = (MIMPI_Message) {.source = source, .tag = tag, .count = count};
-
-    // get access to queue 
-    ASSERT_ZERO(pthread_mutex_lock(&queue.mutex));
-    // go through queue 
-    MIMPI_Node *q_ptr = queue.begin->next, *recv_node = NULL;
+    return MIMPI_send_in(world_comm.context, data, count, destination, tag);
+}
 
-    while (q_ptr != queue.end) {
-        if (match(pattern, q_ptr->msg)) {
-            recv_node = q_ptr;
+// writes out buffered sends in the order they were made
+static void* MIMPI_Bsend_progress(void* arg) {
+    ASSERT_ZERO(pthread_mutex_lock(&bsend.mutex));
+    while (1) {
+        while (bsend.messages == 0 && !bsend.detaching) {
+            ASSERT_ZERO(pthread_cond_wait(&bsend.changed, &bsend.mutex));
+        }
+        if (bsend.messages == 0) {
             break;
         }
-        q_ptr = q_ptr->next;
-    }
 
-    // no matching message found, 
-    // set what message are we looking for before anyone adds to the queue
-    if (!recv_node) {
+        // skip the unused end of the buffer
+        if (bsend.capacity - bsend.head < (int)sizeof(MIMPI_Buffered)
+            || ((MIMPI_Buffered*)(bsend.data + bsend.head))->destination == -1) {
+            bsend.used -= bsend.capacity - bsend.head;
+            bsend.head = 0;
+        }
 
-        msg_pattern = pattern;
-        found_matching_msg = false;
-        q_ptr = q_ptr->prev; // remember last checked node
+        // the message's space is not reused until it's released below
+        MIMPI_Buffered *msg = (MIMPI_Buffered*)(bsend.data + bsend.head);
+        ASSERT_ZERO(pthread_mutex_unlock(&bsend.mutex));
+        MIMPI_Retcode res = MIMPI_write_message(msg->destination, &msg->header, msg+1);
+        ASSERT_ZERO(pthread_mutex_lock(&bsend.mutex));
 
-        if (tag == GROUP_BEGIN || tag == GROUP_END) {
-            while (!found_matching_msg && !left_MIMPI_block[source] && !group_failed) {
-                ASSERT_ZERO(pthread_cond_wait(&matched_msg, &queue.mutex));
-            }
-            if (!found_matching_msg && left_MIMPI_block[source]) {
-                found_matching_msg = true;
-                free(pattern);
-                ASSERT_ZERO(pthread_mutex_unlock(&queue.mutex));
-                MIMPI_Send(NULL, 0, 0, GROUP_FAIL);
-                return MIMPI_ERROR_REMOTE_FINISHED;
-            }
-            if (group_failed) {
-                found_matching_msg = true;
-                free(pattern); 
-                ASSERT_ZERO(pthread_mutex_unlock(&queue.mutex));
-                return MIMPI_ERROR_REMOTE_FINISHED;
-            }
-        }
-        else {
-            while (!found_matching_msg && (tag<0 || !left_MIMPI_block[source])) {
-                ASSERT_ZERO(pthread_cond_wait(&matched_msg, &queue.mutex));
-            }
+        if (res != MIMPI_SUCCESS) {
+            bsend.failed++;
         }
 
-        if (!found_matching_msg) {
-            found_matching_msg = true;
-            free(pattern); 
-            ASSERT_ZERO(pthread_mutex_unlock(&queue.mutex));
-            return MIMPI_ERROR_REMOTE_FINISHED;
-        }
+        bsend.head += msg->size;
+        bsend.used -= msg->size;
+        bsend.messages--;
+        bsend.pending[msg->destination]--;
+        ASSERT_ZERO(pthread_cond_broadcast(&bsend.changed));
+    }
+    ASSERT_ZERO(pthread_mutex_unlock(&bsend.mutex));
+    return NULL;
+}
 
-        // iterate through the rest of the queue until we find the matching one
-        q_ptr = q_ptr->next;
-        while (q_ptr != queue.end) {
-            if (match(pattern, q_ptr->msg)) {
-                recv_node = q_ptr;
-                break;
-            }
-            q_ptr = q_ptr->next;
-        }
+MIMPI_Retcode MIMPI_Buffer_attach(void *buffer, int size) {
+    if (bsend.attached) {
+        void *old_buffer;
+        int old_size;
+        MIMPI_Buffer_detach(&old_buffer, &old_size);
     }
-    ASSERT_ZERO(pthread_mutex_unlock(&queue.mutex));
 
-    // wait until the data is fully buffered
-    ASSERT_ZERO(pthread_mutex_lock(&recv_node->msg->is_buffered));
-    // move the data 
-    if (recv_node->msg->count > 0) {
-        memcpy(data, recv_node->msg->buffer, recv_node->msg->count);
+    ASSERT_NOT_NULL(bsend.pending = calloc(world_size, sizeof(int)));
+    bsend.data = buffer;
+    bsend.capacity = size;
+    bsend.head = bsend.tail = bsend.used = bsend.messages = 0;
+    bsend.peak_used = bsend.overflows = bsend.failed = 0;
+    bsend.detaching = false;
+    bsend.attached = true;
+    ASSERT_ZERO(pthread_create(&bsend.thread, NULL, MIMPI_Bsend_progress, NULL));
+
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Buffer_detach(void **buffer, int *size) {
+    if (!bsend.attached) {
+        *buffer = NULL;
+        *size = 0;
+        return MIMPI_SUCCESS;
     }
-    ASSERT_ZERO(pthread_mutex_unlock(&recv_node->msg->is_buffered));
 
-    // remove node from queue
-    
-    ASSERT_ZERO(pthread_mutex_lock(&queue.mutex));
-    recv_node->prev->next = recv_node->next;
-    recv_node->next->prev = recv_node->prev;
-    ASSERT_ZERO(pthread_mutex_unlock(&queue.mutex));
- 
-    // free it
-    free_MIMPI_Node(recv_node);
-    found_matching_msg = true;
-    free(pattern); // no longer needed
+    ASSERT_ZERO(pthread_mutex_lock(&bsend.mutex));
+    bsend.detaching = true;
+    ASSERT_ZERO(pthread_cond_broadcast(&bsend.changed));
+    ASSERT_ZERO(pthread_mutex_unlock(&bsend.mutex));
+    ASSERT_ZERO(pthread_join(bsend.thread, NULL));
+
+    bsend.attached = false;
+    free(bsend.pending);
+    bsend.pending = NULL;
+    *buffer = bsend.data;
+    *size = bsend.capacity;
 
     return MIMPI_SUCCESS;
 }
 
-MIMPI_Retcode MIMPI_Barrier() {
-    const int l_child = (my_rank+1)*2-1, r_child = l_child+1;
-    const int parent = (my_rank+1)/2-1;
+// finds place for size bytes in the buffer, has to be called with bsend.mutex locked
+static MIMPI_Buffered* MIMPI_bsend_alloc(int size) {
+    if (bsend.used == 0) {
+        bsend.head = bsend.tail = 0;
+    }
 
-    if (l_child < world_size) {
-        ASSERT_MIMPI_RECV_OK(MIMPI_Recv(NULL, 0, l_child, GROUP_BEGIN));
-        if (r_child < world_size) {
-            ASSERT_MIMPI_RECV_OK(MIMPI_Recv(NULL, 0, r_child, GROUP_BEGIN));
+    int place = -1;
+    if (bsend.tail > bsend.head || bsend.used == 0) {
+        if (bsend.capacity - bsend.tail >= size) {
+            place = bsend.tail;
+        }
+        else if (bsend.head >= size) {
+            // wrap around, marking the end of the buffer as unused
+            if (bsend.capacity - bsend.tail >= (int)sizeof(MIMPI_Buffered)) {
+                ((MIMPI_Buffered*)(bsend.data + bsend.tail))->destination = -1;
+            }
+            bsend.used += bsend.capacity - bsend.tail;
+            place = 0;
         }
     }
-    if (my_rank != 0) {
-        MIMPI_Send(NULL, 0, parent, GROUP_BEGIN);
+    else if (bsend.tail < bsend.head && bsend.head - bsend.tail >= size) {
+        place = bsend.tail;
     }
-    
-    if (my_rank != 0) {
-        ASSERT_MIMPI_RECV_OK(MIMPI_Recv(NULL, 0, parent, GROUP_END));
+
+    if (place == -1) {
+        return NULL;
     }
-    if (l_child < world_size) {
-        MIMPI_Send(NULL, 0, l_child, GROUP_END);
-        if(r_child < world_size) {
-            MIMPI_Send(NULL, 0, r_child, GROUP_END);
-        }
+    bsend.tail = place + size;
+    bsend.used += size;
+    bsend.peak_used = MAX(bsend.peak_used, bsend.used);
+    return (MIMPI_Buffered*)(bsend.data + place);
+}
+
+MIMPI_Retcode MIMPI_Bsend(
+    void const *data,
+    int count,
+    int destination,
+    int tag
+) {
+    if (my_rank == destination) 
+        {return MIMPI_ERROR_ATTEMPTED_SELF_OP;}
+    if (destination < 0 || destination >= world_size) 
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+    if (!bsend.attached)
+        {return MIMPI_ERROR_BUFFER_OVERFLOW;}
+
+    // keep every message aligned for its metadata
+    const int align = sizeof(MIMPI_Buffered);
+    const int size = (sizeof(MIMPI_Buffered) + count + align - 1) / align * align;
+
+    ASSERT_ZERO(pthread_mutex_lock(&bsend.mutex));
+    MIMPI_Buffered *msg = MIMPI_bsend_alloc(size);
+    if (msg == NULL) {
+        bsend.overflows++;
+        ASSERT_ZERO(pthread_mutex_unlock(&bsend.mutex));
+        return MIMPI_ERROR_BUFFER_OVERFLOW;
+    }
+
+    msg->destination = destination;
+    msg->size = size;
+    msg->header = (MIMPI_Header) {.tag = tag, .count = count};
+    if (count > 0) {
+        memcpy(msg+1, data, count);
     }
 
+    bsend.messages++;
+    bsend.pending[destination]++;
+    ASSERT_ZERO(pthread_cond_broadcast(&bsend.changed));
+    ASSERT_ZERO(pthread_mutex_unlock(&bsend.mutex));
+
     return MIMPI_SUCCESS;
 }
 
-inline static int MIMPI_real_proc(int rank, int root) {
-    if (rank == root)
-        return 0;
-    if (rank == 0) 
-        return root;
-    return rank;
+MIMPI_Retcode MIMPI_Buffer_stats(MIMPI_Buffer_usage *usage) {
+    ASSERT_ZERO(pthread_mutex_lock(&bsend.mutex));
+    *usage = (MIMPI_Buffer_usage) {
+        .size = bsend.attached ? bsend.capacity : 0,
+        .used = bsend.used,
+        .peak_used = bsend.peak_used,
+        .pending = bsend.messages,
+        .overflows = bsend.overflows,
+        .failed = bsend.failed,
+    };
+    ASSERT_ZERO(pthread_mutex_unlock(&bsend.mutex));
+    return MIMPI_SUCCESS;
 }
 
-MIMPI_Retcode MIMPI_Bcast(
-    void *data,
-    int count,
-    int root
-) {
-    const int treat_as = MIMPI_real_proc(my_rank, root);
-    const int l_child = MIMPI_real_proc((treat_as+1)*2-1, root);
-    const int r_child = MIMPI_real_proc((treat_as+1)*2, root);
-    const int parent = MIMPI_real_proc((treat_as+1)/2-1, root);
-
-    if (l_child < world_size) {
-        ASSERT_MIMPI_RECV_OK(MIMPI_Recv(NULL, 0, l_child, GROUP_BEGIN));
-        if (r_child < world_size) {
-            ASSERT_MIMPI_RECV_OK(MIMPI_Recv(NULL, 0, r_child, GROUP_BEGIN));
+// first message in the queue matching pattern that no receive has taken yet,
+// has to be called with queue.mutex locked
+static MIMPI_Node* MIMPI_search_queue(MIMPI_Message *pattern) {
+    for (MIMPI_Node *q_ptr = queue.begin->next; q_ptr != queue.end; q_ptr = q_ptr->next) {
+        if (!q_ptr->msg->claimed && match(pattern, q_ptr->msg)) {
+            return q_ptr;
         }
     }
-    if (treat_as != 0) {
-        MIMPI_Send(NULL, 0, parent, GROUP_BEGIN);
+    return NULL;
+}
+
+// Posts waiter: takes the first queued message matching its pattern
+// (or, if claim isn't set, only looks at it), and if there is none yet
+// adds the waiter to the list matched by the receiver threads.
+static void MIMPI_post_waiter(MIMPI_Waiter *waiter) {
+    ASSERT_ZERO(pthread_mutex_lock(&queue.mutex));
+    waiter->found = MIMPI_search_queue(waiter->pattern);
+    waiter->next = NULL;
+    if (waiter->found != NULL) {
+        MIMPI_fill_status(&waiter->seen, waiter->found->msg);
     }
 
-    if (treat_as != 0) {
-        ASSERT_MIMPI_RECV_OK(MIMPI_Recv(data, count, parent, GROUP_END));
+    if (waiter->found == NULL) {
+        waiter->prev = waiters.prev;
+        waiter->next = &waiters;
+        waiters.prev->next = waiter;
+        waiters.prev = waiter;
     }
-    if (l_child < world_size) {
-        MIMPI_Send(data, count, l_child, GROUP_END);
-        if(r_child < world_size) {
-            MIMPI_Send(data, count, r_child, GROUP_END);
-        }
+    else if (waiter->claim) {
+        waiter->found->msg->claimed = true;
     }
-    
-    return MIMPI_SUCCESS;
+    ASSERT_ZERO(pthread_mutex_unlock(&queue.mutex));
 }
 
-inline static void reduce_data(char *dest, char *src, int count, const MIMPI_Op op) {
-    for (int i = 0; i < count; i++) {
-        if (op == MIMPI_MAX) 
-            dest[i] = MAX(dest[i], src[i]);
-        else if (op == MIMPI_MIN) 
-            dest[i] = MIN(dest[i], src[i]);
-        else if (op == MIMPI_SUM)
-            dest[i] += src[i];
-        else 
-            dest[i] *= src[i];
+// has to be called with queue.mutex locked
+inline static void MIMPI_unlink_waiter(MIMPI_Waiter *waiter) {
+    if (waiter->next != NULL) {
+        waiter->prev->next = waiter->next;
+        waiter->next->prev = waiter->prev;
+        waiter->next = NULL;
     }
-    return;
 }
 
-MIMPI_Retcode MIMPI_Reduce(
-    void const *send_data,
-    void *recv_data,
-    int count,
-    MIMPI_Op op,
-    int root
-) {
-    const int treat_as = MIMPI_real_proc(my_rank, root);
-    const int l_child = MIMPI_real_proc((treat_as+1)*2-1, root);
-    const int r_child = MIMPI_real_proc((treat_as+1)*2, root);
-    const int parent = MIMPI_real_proc((treat_as+1)/2-1, root);
+// whether the waiter's message can't arrive anymore, needs queue.mutex
+inline static bool MIMPI_waiter_hopeless(MIMPI_Waiter *waiter) {
+    const int source = waiter->pattern->source, tag = waiter->pattern->tag;
+    if (tag == GROUP_BEGIN || tag == GROUP_END) {
+        // communicators don't spread failures, only their own members' exits count
+        return left_MIMPI_block[source] || (group_failed && waiter->pattern->context == 0);
+    }
+    const bool neighbor_op = (tag <= NEIGHBOR_TAG(0) && tag > NEIGHBOR_TAG(NEIGHBOR_SLOTS));
+    return (tag >= 0 || neighbor_op) && left_MIMPI_block[source];
+}
+
+// waits for matched_msg until deadline (if there is one),
+// returns false if it has passed
+inline static bool MIMPI_wait_matched_until(const struct timespec *deadline) {
+    if (deadline == NULL) {
+        ASSERT_ZERO(pthread_cond_wait(&matched_msg, &queue.mutex));
+        return true;
+    }
+    int res = pthread_cond_timedwait(&matched_msg, &queue.mutex, deadline);
+    if (res == ETIMEDOUT) {
+        return false;
+    }
+    ASSERT_ZERO(res);
+    return true;
+}
+
+// Waits until a posted waiter gets its message or deadline (CLOCK_MONOTONIC,
+// NULL for none) passes. When claim is not set waiter->found shouldn't be
+// touched after returning.
+static MIMPI_Retcode MIMPI_wait_waiter_until(
+    MIMPI_Waiter *waiter,
+    MIMPI_Status *status,
+    const struct timespec *deadline
+) {
+    const int source = waiter->pattern->source, tag = waiter->pattern->tag;
+    const bool group_op = (tag == GROUP_BEGIN || tag == GROUP_END);
+    bool timed_out = false;
+
+    ASSERT_ZERO(pthread_mutex_lock(&queue.mutex));
+    while (!waiter->found && !MIMPI_waiter_hopeless(waiter) && !timed_out) {
+        timed_out = !MIMPI_wait_matched_until(deadline);
+    }
+    MIMPI_unlink_waiter(waiter);
+
+    if (!waiter->found && timed_out) {
+        ASSERT_ZERO(pthread_mutex_unlock(&queue.mutex));
+        return MIMPI_ERROR_TIMEOUT;
+    }
+    if (!waiter->found) {
+        ASSERT_ZERO(pthread_mutex_unlock(&queue.mutex));
+        if (group_op && left_MIMPI_block[source] && waiter->pattern->context == 0) {
+            MIMPI_Send(NULL, 0, 0, GROUP_FAIL);
+        }
+        return MIMPI_ERROR_REMOTE_FINISHED;
+    }
+
+    if (status != NULL) {
+        *status = waiter->seen;
+    }
+    ASSERT_ZERO(pthread_mutex_unlock(&queue.mutex));
+    return MIMPI_SUCCESS;
+}
+
+inline static MIMPI_Retcode MIMPI_wait_waiter(MIMPI_Waiter *waiter, MIMPI_Status *status) {
+    return MIMPI_wait_waiter_until(waiter, status, NULL);
+}
+
+// withdraws a posted waiter, giving back the message it has claimed
+static void MIMPI_cancel_waiter(MIMPI_Waiter *waiter) {
+    ASSERT_ZERO(pthread_mutex_lock(&queue.mutex));
+    MIMPI_unlink_waiter(waiter);
+    if (waiter->found && waiter->claim) {
+        waiter->found->msg->claimed = false;
+        MIMPI_match_waiters(waiter->found);
+    }
+    waiter->found = NULL;
+    ASSERT_ZERO(pthread_mutex_unlock(&queue.mutex));
+}
+
+// Waits for the first message matching pattern. If claim is set the message
+// is taken and no other receive can match it anymore, otherwise it is only
+// looked at (and *node shouldn't be touched after returning).
+static MIMPI_Retcode MIMPI_wait_message(
+    MIMPI_Message *pattern,
+    bool claim,
+    MIMPI_Node **node,
+    MIMPI_Status *status
+) {
+    MIMPI_Waiter waiter = {.pattern = pattern, .claim = claim};
+    MIMPI_post_waiter(&waiter);
+    MIMPI_Retcode res = MIMPI_wait_waiter(&waiter, status);
+    *node = waiter.found;
+    return res;
+}
+
+// copies (at most count bytes of) a claimed message's data to the place
+// walked over by c once it's fully buffered and removes the message from the queue
+static void MIMPI_consume_scattered(MIMPI_Node *node, MIMPI_Cursor *c, int count) {
+    // wait until the data is fully buffered
+    ASSERT_ZERO(pthread_mutex_lock(&node->msg->is_buffered));
+    // move the data 
+    if (MIN(count, node->msg->count) > 0) {
+        MIMPI_cursor_copy(c, node->msg->buffer, MIN(count, node->msg->count), false);
+    }
+    ASSERT_ZERO(pthread_mutex_unlock(&node->msg->is_buffered));
+
+    // remove node from queue
+    ASSERT_ZERO(pthread_mutex_lock(&queue.mutex));
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    ASSERT_ZERO(pthread_mutex_unlock(&queue.mutex));
+ 
+    // free it
+    free_MIMPI_Node(node);
+}
+
+inline static void MIMPI_consume_message(MIMPI_Node *node, void *data, int count) {
+    struct iovec iov = {.iov_base = data, .iov_len = count};
+    MIMPI_Cursor c = MIMPI_iov_cursor(&iov, 1);
+    MIMPI_consume_scattered(node, &c, count);
+}
+
+// receives within the communicator with the given context, from a world rank
+static MIMPI_Retcode MIMPI_recv_in(
+    int context,
+    void *data,
+    int count,
+    int source,
+    int tag
+) {
+    MIMPI_Message pattern = {.source = source, .tag = tag, .count = count, .context = context};
+    MIMPI_Node *recv_node;
+    MIMPI_Retcode res = MIMPI_wait_message(&pattern, true, &recv_node, NULL);
+    if (res != MIMPI_SUCCESS) {
+        return res;
+    }
+
+    MIMPI_consume_message(recv_node, data, count);
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Recv(
+    void *data,
+    int count,
+    int source,
+    int tag
+) {
+    if (my_rank == source) 
+        {return MIMPI_ERROR_ATTEMPTED_SELF_OP;}
+    if (source < 0 || source >= world_size) 
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    return MIMPI_recv_in(world_comm.context, data, count, source, tag);
+}
+
+MIMPI_Retcode MIMPI_Recv_deadline(
+    void *data,
+    int count,
+    int source,
+    int tag,
+    const struct timespec *deadline
+) {
+    if (my_rank == source) 
+        {return MIMPI_ERROR_ATTEMPTED_SELF_OP;}
+    if (source < 0 || source >= world_size) 
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    MIMPI_Message pattern = {.source = source, .tag = tag, .count = count};
+    MIMPI_Waiter waiter = {.pattern = &pattern, .claim = true};
+    MIMPI_post_waiter(&waiter);
+    MIMPI_Retcode res = MIMPI_wait_waiter_until(&waiter, NULL, deadline);
+    if (res != MIMPI_SUCCESS) {
+        return res;
+    }
+
+    MIMPI_consume_message(waiter.found, data, count);
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Recv_timeout(
+    void *data,
+    int count,
+    int source,
+    int tag,
+    int timeout_ms
+) {
+    struct timespec deadline;
+    ASSERT_SYS_OK(clock_gettime(CLOCK_MONOTONIC, &deadline));
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000;
+    if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+    return MIMPI_Recv_deadline(data, count, source, tag, &deadline);
+}
+
+MIMPI_Retcode MIMPI_Recv_status(
+    void *data,
+    int max_count,
+    int source,
+    int tag,
+    MIMPI_Status *status
+) {
+    if (my_rank == source) 
+        {return MIMPI_ERROR_ATTEMPTED_SELF_OP;}
+    if (source < 0 || source >= world_size) 
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    MIMPI_Message pattern = {.source = source, .tag = tag, .count = MIMPI_ANY_COUNT};
+    MIMPI_Status recv_status;
+    MIMPI_Node *recv_node;
+    MIMPI_Retcode res = MIMPI_wait_message(&pattern, true, &recv_node, &recv_status);
+    if (res != MIMPI_SUCCESS) {
+        return res;
+    }
+
+    MIMPI_consume_message(recv_node, data, max_count);
+    if (status != NULL) {
+        *status = recv_status;
+    }
+    return (recv_status.count > max_count ? MIMPI_ERROR_TRUNCATED : MIMPI_SUCCESS);
+}
+
+MIMPI_Retcode MIMPI_Probe(
+    int source,
+    int tag,
+    MIMPI_Status *status
+) {
+    if (my_rank == source) 
+        {return MIMPI_ERROR_ATTEMPTED_SELF_OP;}
+    if (source < 0 || source >= world_size) 
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    MIMPI_Message pattern = {.source = source, .tag = tag, .count = MIMPI_ANY_COUNT};
+    MIMPI_Node *node;
+    return MIMPI_wait_message(&pattern, false, &node, status);
+}
+
+MIMPI_Retcode MIMPI_Iprobe(
+    int source,
+    int tag,
+    bool *flag,
+    MIMPI_Status *status
+) {
+    if (my_rank == source) 
+        {return MIMPI_ERROR_ATTEMPTED_SELF_OP;}
+    if (source < 0 || source >= world_size) 
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    MIMPI_Message pattern = {.source = source, .tag = tag, .count = MIMPI_ANY_COUNT};
+    MIMPI_Retcode res = MIMPI_SUCCESS;
+
+    ASSERT_ZERO(pthread_mutex_lock(&queue.mutex));
+    MIMPI_Node *node = MIMPI_search_queue(&pattern);
+    *flag = (node != NULL);
+    if (node) {
+        MIMPI_fill_status(status, node->msg);
+    }
+    else if (left_MIMPI_block[source]) {
+        res = MIMPI_ERROR_REMOTE_FINISHED;
+    }
+    ASSERT_ZERO(pthread_mutex_unlock(&queue.mutex));
+
+    return res;
+}
+
+MIMPI_Retcode MIMPI_Mprobe(
+    int source,
+    int tag,
+    MIMPI_Message_handle *message,
+    MIMPI_Status *status
+) {
+    if (my_rank == source) 
+        {return MIMPI_ERROR_ATTEMPTED_SELF_OP;}
+    if (source < 0 || source >= world_size) 
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    MIMPI_Message pattern = {.source = source, .tag = tag, .count = MIMPI_ANY_COUNT};
+    *message = MIMPI_MESSAGE_NULL;
+    return MIMPI_wait_message(&pattern, true, message, status);
+}
+
+MIMPI_Retcode MIMPI_Mrecv(
+    void *data,
+    MIMPI_Message_handle *message
+) {
+    if (*message != MIMPI_MESSAGE_NULL) {
+        MIMPI_consume_message(*message, data, (*message)->msg->count);
+        *message = MIMPI_MESSAGE_NULL;
+    }
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Sendv(
+    const struct iovec *iov,
+    int iovcnt,
+    int destination,
+    int tag
+) {
+    if (my_rank == destination) 
+        {return MIMPI_ERROR_ATTEMPTED_SELF_OP;}
+    if (destination < 0 || destination >= world_size) 
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    MIMPI_Header header = {.tag = tag, .count = 0};
+    for (int i = 0; i < iovcnt; i++) {
+        header.count += iov[i].iov_len;
+    }
+    MIMPI_Cursor c = MIMPI_iov_cursor(iov, iovcnt);
+    return MIMPI_send_gathered(destination, &header, &c);
+}
+
+MIMPI_Retcode MIMPI_Recvv(
+    const struct iovec *iov,
+    int iovcnt,
+    int source,
+    int tag
+) {
+    if (my_rank == source) 
+        {return MIMPI_ERROR_ATTEMPTED_SELF_OP;}
+    if (source < 0 || source >= world_size) 
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    MIMPI_Message pattern = {.source = source, .tag = tag, .count = 0};
+    for (int i = 0; i < iovcnt; i++) {
+        pattern.count += iov[i].iov_len;
+    }
+    MIMPI_Node *recv_node;
+    MIMPI_Retcode res = MIMPI_wait_message(&pattern, true, &recv_node, NULL);
+    if (res != MIMPI_SUCCESS) {
+        return res;
+    }
+
+    MIMPI_Cursor c = MIMPI_iov_cursor(iov, iovcnt);
+    MIMPI_consume_scattered(recv_node, &c, pattern.count);
+    return MIMPI_SUCCESS;
+}
+
+// appends a piece of data to a datatype being built, merging it with
+// the previous one if they are adjacent
+static void MIMPI_type_append(MIMPI_Datatype type, ptrdiff_t offset, int length, int *capacity) {
+    type->size += length;
+    type->extent = MAX(type->extent, offset + length);
+
+    if (type->segments > 0) {
+        MIMPI_Segment *last = &type->segment[type->segments-1];
+        if (last->offset + last->length == offset) {
+            last->length += length;
+            return;
+        }
+    }
+    if (type->segments == *capacity) {
+        *capacity = MAX(2 * *capacity, 8);
+        ASSERT_NOT_NULL(type->segment = realloc(type->segment, *capacity * sizeof(MIMPI_Segment)));
+    }
+    type->segment[type->segments++] = (MIMPI_Segment) {.offset = offset, .length = length};
+}
+
+// appends count elements of old starting at offset
+static void MIMPI_type_append_elements(MIMPI_Datatype type, ptrdiff_t offset, int count, 
+                                       MIMPI_Datatype old, int *capacity) {
+    old = MIMPI_type(old);
+    for (int i = 0; i < count; i++) {
+        for (int j = 0; j < old->segments; j++) {
+            MIMPI_type_append(type, offset + i * old->extent + old->segment[j].offset,
+                              old->segment[j].length, capacity);
+        }
+    }
+}
+
+// finishes a datatype, spotting equally spaced segments of the same length
+static MIMPI_Retcode MIMPI_type_commit(MIMPI_Datatype type, MIMPI_Datatype *newtype) {
+    type->stride = 0;
+    if (type->segments > 1) {
+        type->stride = type->segment[1].offset - type->segment[0].offset;
+        for (int i = 1; i < type->segments && type->stride != 0; i++) {
+            if (type->segment[i].length != type->segment[0].length
+                || type->segment[i].offset - type->segment[i-1].offset != type->stride) {
+                type->stride = 0;
+            }
+        }
+    }
+    *newtype = type;
+    return MIMPI_SUCCESS;
+}
+
+inline static MIMPI_Datatype MIMPI_new_type() {
+    MIMPI_Datatype type = calloc(1, sizeof(struct MIMPI_Datatype_data));
+    ASSERT_NOT_NULL(type);
+    return type;
+}
+
+MIMPI_Retcode MIMPI_Type_vector(
+    int count,
+    int blocklength,
+    int stride,
+    MIMPI_Datatype oldtype,
+    MIMPI_Datatype *newtype
+) {
+    MIMPI_Datatype type = MIMPI_new_type();
+    const ptrdiff_t old_extent = MIMPI_type(oldtype)->extent;
+    int capacity = 0;
+    for (int i = 0; i < count; i++) {
+        MIMPI_type_append_elements(type, i * stride * old_extent, blocklength, oldtype, &capacity);
+    }
+    return MIMPI_type_commit(type, newtype);
+}
+
+MIMPI_Retcode MIMPI_Type_indexed(
+    int count,
+    const int blocklengths[],
+    const int displacements[],
+    MIMPI_Datatype oldtype,
+    MIMPI_Datatype *newtype
+) {
+    MIMPI_Datatype type = MIMPI_new_type();
+    const ptrdiff_t old_extent = MIMPI_type(oldtype)->extent;
+    int capacity = 0;
+    for (int i = 0; i < count; i++) {
+        MIMPI_type_append_elements(type, displacements[i] * old_extent, blocklengths[i], 
+                                   oldtype, &capacity);
+    }
+    return MIMPI_type_commit(type, newtype);
+}
+
+MIMPI_Retcode MIMPI_Type_create_struct(
+    int count,
+    const int blocklengths[],
+    const int displacements[],
+    const MIMPI_Datatype types[],
+    MIMPI_Datatype *newtype
+) {
+    MIMPI_Datatype type = MIMPI_new_type();
+    int capacity = 0;
+    for (int i = 0; i < count; i++) {
+        MIMPI_type_append_elements(type, displacements[i], blocklengths[i], types[i], &capacity);
+    }
+    return MIMPI_type_commit(type, newtype);
+}
+
+MIMPI_Retcode MIMPI_Type_size(MIMPI_Datatype type, int *size) {
+    *size = MIMPI_type(type)->size;
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Type_free(MIMPI_Datatype *type) {
+    if (*type != MIMPI_BYTE) {
+        free((*type)->segment);
+        free(*type);
+        *type = MIMPI_BYTE;
+    }
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Pack(
+    void const *data,
+    int count,
+    MIMPI_Datatype type,
+    void *packed
+) {
+    MIMPI_Cursor c = MIMPI_type_cursor(data, count, type);
+    MIMPI_cursor_copy(&c, packed, count * MIMPI_type(type)->size, true);
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Unpack(
+    void const *packed,
+    void *data,
+    int count,
+    MIMPI_Datatype type
+) {
+    MIMPI_Cursor c = MIMPI_type_cursor(data, count, type);
+    MIMPI_cursor_copy(&c, (void*)packed, count * MIMPI_type(type)->size, false);
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Send_typed(
+    void const *data,
+    int count,
+    MIMPI_Datatype type,
+    int destination,
+    int tag
+) {
+    if (my_rank == destination) 
+        {return MIMPI_ERROR_ATTEMPTED_SELF_OP;}
+    if (destination < 0 || destination >= world_size) 
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    MIMPI_Header header = {.tag = tag, .count = count * MIMPI_type(type)->size};
+    MIMPI_Cursor c = MIMPI_type_cursor(data, count, type);
+    return MIMPI_send_gathered(destination, &header, &c);
+}
+
+MIMPI_Retcode MIMPI_Recv_typed(
+    void *data,
+    int count,
+    MIMPI_Datatype type,
+    int source,
+    int tag
+) {
+    if (my_rank == source) 
+        {return MIMPI_ERROR_ATTEMPTED_SELF_OP;}
+    if (source < 0 || source >= world_size) 
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    MIMPI_Message pattern = {.source = source, .tag = tag, .count = count * MIMPI_type(type)->size};
+    MIMPI_Node *recv_node;
+    MIMPI_Retcode res = MIMPI_wait_message(&pattern, true, &recv_node, NULL);
+    if (res != MIMPI_SUCCESS) {
+        return res;
+    }
+
+    MIMPI_Cursor c = MIMPI_type_cursor(data, count, type);
+    MIMPI_consume_scattered(recv_node, &c, pattern.count);
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Sendrecv(
+    void const *send_data,
+    int send_count,
+    int destination,
+    int send_tag,
+    void *recv_data,
+    int recv_count,
+    int source,
+    int recv_tag
+) {
+    if (my_rank == destination || my_rank == source) 
+        {return MIMPI_ERROR_ATTEMPTED_SELF_OP;}
+    if (destination < 0 || destination >= world_size || source < 0 || source >= world_size) 
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    // post the receive first, so that the incoming message is matched
+    // (and buffered by the receiver thread) while we are still sending
+    MIMPI_Message pattern = {.source = source, .tag = recv_tag, .count = recv_count};
+    MIMPI_Waiter waiter = {.pattern = &pattern, .claim = true};
+    MIMPI_post_waiter(&waiter);
+
+    MIMPI_Retcode res = MIMPI_Send(send_data, send_count, destination, send_tag);
+    if (res != MIMPI_SUCCESS) {
+        MIMPI_cancel_waiter(&waiter);
+        return res;
+    }
+
+    res = MIMPI_wait_waiter(&waiter, NULL);
+    if (res != MIMPI_SUCCESS) {
+        return res;
+    }
+    MIMPI_consume_message(waiter.found, recv_data, recv_count);
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Sendrecv_replace(
+    void *data,
+    int count,
+    int destination,
+    int send_tag,
+    int source,
+    int recv_tag
+) {
+    // the received message is only copied out of the queue after
+    // the whole send is done, so data can be reused right away
+    return MIMPI_Sendrecv(data, count, destination, send_tag, 
+                          data, count, source, recv_tag);
+}
+
+MIMPI_Retcode MIMPI_Send_init(
+    void const *data,
+    int count,
+    int destination,
+    int tag,
+    MIMPI_Request *request
+) {
+    if (my_rank == destination) 
+        {return MIMPI_ERROR_ATTEMPTED_SELF_OP;}
+    if (destination < 0 || destination >= world_size) 
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    MIMPI_Request req = calloc(1, sizeof(struct MIMPI_Request_data));
+    ASSERT_NOT_NULL(req);
+    req->kind = MIMPI_REQUEST_SEND;
+    req->data = (void*)data;
+    req->peer = destination;
+    req->header = (MIMPI_Header) {.tag = tag, .count = count};
+
+    *request = req;
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Recv_init(
+    void *data,
+    int count,
+    int source,
+    int tag,
+    MIMPI_Request *request
+) {
+    if (my_rank == source) 
+        {return MIMPI_ERROR_ATTEMPTED_SELF_OP;}
+    if (source < 0 || source >= world_size) 
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    MIMPI_Request req = calloc(1, sizeof(struct MIMPI_Request_data));
+    ASSERT_NOT_NULL(req);
+    req->kind = MIMPI_REQUEST_RECV;
+    req->data = data;
+    req->peer = source;
+    req->pattern = (MIMPI_Message) {.source = source, .tag = tag, .count = count};
+    req->waiter = (MIMPI_Waiter) {.pattern = &req->pattern, .claim = true};
+
+    *request = req;
+    return MIMPI_SUCCESS;
+}
+
+static void MIMPI_queue_collective(MIMPI_Request req); // with the collectives
+
+MIMPI_Retcode MIMPI_Start(MIMPI_Request *request) {
+    MIMPI_Request req = *request;
+    req->active = true;
+
+    switch (req->kind) {
+        case MIMPI_REQUEST_SEND:
+            // the receiver threads keep draining pipes,
+            // so sending right away never waits for the receive
+            req->result = MIMPI_send_message(req->peer, &req->header, req->data);
+            break;
+        case MIMPI_REQUEST_RECV:
+            MIMPI_post_waiter(&req->waiter);
+            break;
+        case MIMPI_REQUEST_PSEND:
+            // partitions are sent by MIMPI_Pready
+            req->done = 0;
+            req->result = MIMPI_SUCCESS;
+            break;
+        case MIMPI_REQUEST_PRECV:
+            for (int i = 0; i < req->partitions; i++) {
+                req->arrived[i] = false;
+                MIMPI_post_waiter(&req->waiters[i]);
+            }
+            break;
+        case MIMPI_REQUEST_COLL:
+            MIMPI_queue_collective(req);
+            break;
+    }
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Startall(int count, MIMPI_Request requests[]) {
+    // post all receives before any send
+    for (int i = 0; i < count; i++) {
+        if (MIMPI_is_receive(requests[i])) {
+            MIMPI_Start(&requests[i]);
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        if (!MIMPI_is_receive(requests[i])) {
+            MIMPI_Start(&requests[i]);
+        }
+    }
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Wait(MIMPI_Request *request) {
+    MIMPI_Request req = *request;
+    if (req == MIMPI_REQUEST_NULL || !req->active) {
+        return MIMPI_SUCCESS;
+    }
+    req->active = false;
+
+    switch (req->kind) {
+        case MIMPI_REQUEST_SEND:
+            return req->result;
+        case MIMPI_REQUEST_RECV:
+            req->result = MIMPI_wait_waiter(&req->waiter, NULL);
+            if (req->result == MIMPI_SUCCESS) {
+                MIMPI_consume_message(req->waiter.found, req->data, req->pattern.count);
+            }
+            return req->result;
+        case MIMPI_REQUEST_PSEND:
+            ASSERT_ZERO(pthread_mutex_lock(&req->mutex));
+            while (req->done < req->partitions) {
+                ASSERT_ZERO(pthread_cond_wait(&req->all_done, &req->mutex));
+            }
+            ASSERT_ZERO(pthread_mutex_unlock(&req->mutex));
+            return req->result;
+        case MIMPI_REQUEST_PRECV:
+            req->result = MIMPI_SUCCESS;
+            for (int i = 0; i < req->partitions; i++) {
+                if (req->arrived[i]) {
+                    continue;
+                }
+                MIMPI_Retcode res = MIMPI_wait_waiter(&req->waiters[i], NULL);
+                if (res == MIMPI_SUCCESS) {
+                    MIMPI_consume_message(req->waiters[i].found, 
+                                          req->data + i * req->count, req->count);
+                    req->arrived[i] = true;
+                }
+                else if (req->result == MIMPI_SUCCESS) {
+                    req->result = res;
+                }
+            }
+            return req->result;
+        case MIMPI_REQUEST_COLL:
+            ASSERT_ZERO(pthread_mutex_lock(&coll.mutex));
+            while (!req->finished) {
+                ASSERT_ZERO(pthread_cond_wait(&coll.changed, &coll.mutex));
+            }
+            ASSERT_ZERO(pthread_mutex_unlock(&coll.mutex));
+            MIMPI_Retcode res = req->result;
+            // nonblocking collectives are used once
+            if (!req->persistent) {
+                free(req);
+                *request = MIMPI_REQUEST_NULL;
+            }
+            return res;
+    }
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Test(MIMPI_Request *request, bool *flag) {
+    MIMPI_Request req = *request;
+    if (req == MIMPI_REQUEST_NULL || !req->active) {
+        *flag = true;
+        return MIMPI_SUCCESS;
+    }
+
+    switch (req->kind) {
+        case MIMPI_REQUEST_SEND:
+            *flag = true;
+            break;
+        case MIMPI_REQUEST_RECV:
+            ASSERT_ZERO(pthread_mutex_lock(&queue.mutex));
+            *flag = (req->waiter.found != NULL || MIMPI_waiter_hopeless(&req->waiter));
+            ASSERT_ZERO(pthread_mutex_unlock(&queue.mutex));
+            break;
+        case MIMPI_REQUEST_PSEND:
+            ASSERT_ZERO(pthread_mutex_lock(&req->mutex));
+            *flag = (req->done == req->partitions);
+            ASSERT_ZERO(pthread_mutex_unlock(&req->mutex));
+            break;
+        case MIMPI_REQUEST_PRECV:
+            *flag = true;
+            ASSERT_ZERO(pthread_mutex_lock(&queue.mutex));
+            for (int i = 0; i < req->partitions; i++) {
+                if (!req->arrived[i] && req->waiters[i].found == NULL
+                    && !MIMPI_waiter_hopeless(&req->waiters[i])) {
+                    *flag = false;
+                }
+            }
+            ASSERT_ZERO(pthread_mutex_unlock(&queue.mutex));
+            break;
+        case MIMPI_REQUEST_COLL:
+            ASSERT_ZERO(pthread_mutex_lock(&coll.mutex));
+            *flag = req->finished;
+            ASSERT_ZERO(pthread_mutex_unlock(&coll.mutex));
+            break;
+    }
+
+    // completing doesn't block anymore
+    if (*flag) {
+        return MIMPI_Wait(request);
+    }
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Waitall(int count, MIMPI_Request requests[]) {
+    MIMPI_Retcode res = MIMPI_SUCCESS;
+    for (int i = 0; i < count; i++) {
+        MIMPI_Retcode req_res = MIMPI_Wait(&requests[i]);
+        if (res == MIMPI_SUCCESS) {
+            res = req_res;
+        }
+    }
+    return res;
+}
+
+MIMPI_Retcode MIMPI_Request_free(MIMPI_Request *request) {
+    MIMPI_Request req = *request;
+    if (req == MIMPI_REQUEST_NULL) {
+        return MIMPI_SUCCESS;
+    }
+    if (req->active && req->kind == MIMPI_REQUEST_COLL) {
+        // the collective can't be taken back from the other processes
+        MIMPI_Wait(request);
+        if (*request == MIMPI_REQUEST_NULL) {
+            return MIMPI_SUCCESS;
+        }
+    }
+    if (req->active && req->kind == MIMPI_REQUEST_RECV) {
+        MIMPI_cancel_waiter(&req->waiter);
+    }
+    if (req->kind == MIMPI_REQUEST_PRECV) {
+        for (int i = 0; i < req->partitions; i++) {
+            if (req->active && !req->arrived[i]) {
+                MIMPI_cancel_waiter(&req->waiters[i]);
+            }
+        }
+        free(req->patterns);
+        free(req->waiters);
+        free(req->arrived);
+    }
+    if (req->kind == MIMPI_REQUEST_PSEND) {
+        ASSERT_ZERO(pthread_mutex_destroy(&req->mutex));
+        ASSERT_ZERO(pthread_cond_destroy(&req->all_done));
+    }
+    if (req->kind == MIMPI_REQUEST_COLL) {
+        free(req->scratch);
+    }
+    free(req);
+    *request = MIMPI_REQUEST_NULL;
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Psend_init(
+    void const *data,
+    int partitions,
+    int count,
+    int destination,
+    int tag,
+    MIMPI_Request *request
+) {
+    if (my_rank == destination) 
+        {return MIMPI_ERROR_ATTEMPTED_SELF_OP;}
+    if (destination < 0 || destination >= world_size) 
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    MIMPI_Request req = calloc(1, sizeof(struct MIMPI_Request_data));
+    ASSERT_NOT_NULL(req);
+    req->kind = MIMPI_REQUEST_PSEND;
+    req->data = (void*)data;
+    req->peer = destination;
+    req->header = (MIMPI_Header) {.tag = tag, .count = count};
+    req->partitions = partitions;
+    req->count = count;
+    ASSERT_ZERO(pthread_mutex_init(&req->mutex, NULL));
+    ASSERT_ZERO(pthread_cond_init(&req->all_done, NULL));
+
+    *request = req;
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Precv_init(
+    void *data,
+    int partitions,
+    int count,
+    int source,
+    int tag,
+    MIMPI_Request *request
+) {
+    if (my_rank == source) 
+        {return MIMPI_ERROR_ATTEMPTED_SELF_OP;}
+    if (source < 0 || source >= world_size) 
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    MIMPI_Request req = calloc(1, sizeof(struct MIMPI_Request_data));
+    ASSERT_NOT_NULL(req);
+    req->kind = MIMPI_REQUEST_PRECV;
+    req->data = data;
+    req->peer = source;
+    req->partitions = partitions;
+    req->count = count;
+    ASSERT_NOT_NULL(req->patterns = malloc(partitions * sizeof(MIMPI_Message)));
+    ASSERT_NOT_NULL(req->waiters = malloc(partitions * sizeof(MIMPI_Waiter)));
+    ASSERT_NOT_NULL(req->arrived = malloc(partitions * sizeof(bool)));
+    for (int i = 0; i < partitions; i++) {
+        req->patterns[i] = (MIMPI_Message) {
+            .source = source, .tag = tag, .count = count, .part = i+1
+        };
+        req->waiters[i] = (MIMPI_Waiter) {.pattern = &req->patterns[i], .claim = true};
+    }
+
+    *request = req;
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Pready(int partition, MIMPI_Request request) {
+    MIMPI_Header header = request->header;
+    header.part = partition+1;
+    MIMPI_Retcode res = MIMPI_send_message(request->peer, &header, 
+                                           request->data + partition * request->count);
+
+    ASSERT_ZERO(pthread_mutex_lock(&request->mutex));
+    if (res != MIMPI_SUCCESS) {
+        request->result = res;
+    }
+    if (++request->done == request->partitions) {
+        ASSERT_ZERO(pthread_cond_broadcast(&request->all_done));
+    }
+    ASSERT_ZERO(pthread_mutex_unlock(&request->mutex));
+
+    return res;
+}
+
+MIMPI_Retcode MIMPI_Parrived(MIMPI_Request request, int partition, bool *flag) {
+    MIMPI_Waiter *waiter = &request->waiters[partition];
+    *flag = request->arrived[partition];
+    if (*flag) {
+        return MIMPI_SUCCESS;
+    }
+
+    ASSERT_ZERO(pthread_mutex_lock(&queue.mutex));
+    MIMPI_Node *found = waiter->found;
+    if (found) {
+        MIMPI_unlink_waiter(waiter);
+    }
+    const bool finished = left_MIMPI_block[request->peer];
+    ASSERT_ZERO(pthread_mutex_unlock(&queue.mutex));
+
+    if (!found) {
+        return (finished ? MIMPI_ERROR_REMOTE_FINISHED : MIMPI_SUCCESS);
+    }
+
+    // the partition's data is still being read
+    if (pthread_mutex_trylock(&found->msg->is_buffered) != 0) {
+        return MIMPI_SUCCESS;
+    }
+    ASSERT_ZERO(pthread_mutex_unlock(&found->msg->is_buffered));
+
+    MIMPI_consume_message(found, request->data + partition * request->count, request->count);
+    request->arrived[partition] = *flag = true;
+    return MIMPI_SUCCESS;
+}
+
+// Waits until all queued nonblocking collectives finish, so that collectives
+// are performed in the order they were called.
+static void MIMPI_collectives_flush() {
+    if (coll.started && pthread_equal(pthread_self(), coll.thread)) {
+        return;
+    }
+    ASSERT_ZERO(pthread_mutex_lock(&coll.mutex));
+    while (coll.head != NULL) {
+        ASSERT_ZERO(pthread_cond_wait(&coll.changed, &coll.mutex));
+    }
+    ASSERT_ZERO(pthread_mutex_unlock(&coll.mutex));
+}
+
+static MIMPI_Retcode MIMPI_tree_barrier() {
+    const int l_child = (my_rank+1)*2-1, r_child = l_child+1;
+    const int parent = (my_rank+1)/2-1;
+
+    if (l_child < world_size) {
+        ASSERT_MIMPI_RECV_OK(MIMPI_Recv(NULL, 0, l_child, GROUP_BEGIN));
+        if (r_child < world_size) {
+            ASSERT_MIMPI_RECV_OK(MIMPI_Recv(NULL, 0, r_child, GROUP_BEGIN));
+        }
+    }
+    if (my_rank != 0) {
+        MIMPI_Send(NULL, 0, parent, GROUP_BEGIN);
+    }
+    
+    if (my_rank != 0) {
+        ASSERT_MIMPI_RECV_OK(MIMPI_Recv(NULL, 0, parent, GROUP_END));
+    }
+    if (l_child < world_size) {
+        MIMPI_Send(NULL, 0, l_child, GROUP_END);
+        if(r_child < world_size) {
+            MIMPI_Send(NULL, 0, r_child, GROUP_END);
+        }
+    }
+
+    return MIMPI_SUCCESS;
+}
+
+// In round k every process signals my_rank + 2^k and waits for my_rank - 2^k.
+// After ceil(log2(world_size)) rounds each process has heard, directly or not,
+// from all the others. Within one barrier every pair talks at most once,
+// since all distances 2^k are different and below world_size.
+static MIMPI_Retcode MIMPI_dissemination_barrier() {
+    for (int dist = 1; dist < world_size; dist <<= 1) {
+        MIMPI_Send(NULL, 0, (my_rank + dist) % world_size, GROUP_BEGIN);
+        ASSERT_MIMPI_RECV_OK(MIMPI_Recv(NULL, 0, (my_rank - dist + world_size) % world_size, GROUP_BEGIN));
+    }
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Barrier() {
+    MIMPI_collectives_flush();
+    if (barrier_algorithm == MIMPI_BARRIER_DISSEMINATION) {
+        return MIMPI_dissemination_barrier();
+    }
+    return MIMPI_tree_barrier();
+}
+
+MIMPI_Retcode MIMPI_Set_barrier_algorithm(MIMPI_Barrier_algorithm algorithm) {
+    // barriers already started keep the algorithm they were started with
+    MIMPI_collectives_flush();
+    barrier_algorithm = algorithm;
+    return MIMPI_SUCCESS;
+}
+
+inline static int MIMPI_real_proc(int rank, int root) {
+    if (rank == root)
+        return 0;
+    if (rank == 0) 
+        return root;
+    return rank;
+}
+
+// neighbours of this process in the heap-shaped tree over communicator's
+// members, with root swapped with member 0
+inline static MIMPI_Tree MIMPI_comm_tree(MIMPI_Comm comm, int root) {
+    const int treat_as = MIMPI_real_proc(comm->rank, root);
+    MIMPI_Tree tree = {.parent = -1, .child_count = 0, .context = comm->context};
+    if (treat_as != 0) {
+        tree.parent = comm->ranks[MIMPI_real_proc((treat_as+1)/2-1, root)];
+    }
+    for (int child = (treat_as+1)*2-1; child <= (treat_as+1)*2 && child < comm->size; child++) {
+        tree.children[tree.child_count++] = comm->ranks[MIMPI_real_proc(child, root)];
+    }
+    return tree;
+}
+
+inline static MIMPI_Tree MIMPI_heap_tree(int root) {
+    return MIMPI_comm_tree(&world_comm, root);
+}
+
+// bytes in each segment of count bytes of pipelined data but the last one,
+// fixed is the size set by the user or 0
+static int MIMPI_pipeline_segment(int count, int fixed) {
+    if (fixed > 0) {
+        return MIN(fixed, MAX(count, 1));
+    }
+    if (count < PIPELINE_THRESHOLD) {
+        return MAX(count, 1);
+    }
+    return MAX(PIPELINE_MIN_SEGMENT, count / PIPELINE_SEGMENTS);
+}
+
+// Data go down in segments, each forwarded to the children right after it
+// arrives, so deeper processes receive one segment while the parent
+// receives the next one.
+static MIMPI_Retcode MIMPI_tree_bcast(MIMPI_Tree const *tree, void *data, int count) {
+    for (int i = 0; i < tree->child_count; i++) {
+        ASSERT_MIMPI_RECV_OK(MIMPI_recv_in(tree->context, NULL, 0, tree->children[i], GROUP_BEGIN));
+    }
+    if (tree->parent != -1) {
+        MIMPI_send_in(tree->context, NULL, 0, tree->parent, GROUP_BEGIN);
+    }
+
+    const int segment = MIMPI_pipeline_segment(count, bcast_segment);
+    int offset = 0;
+    do {
+        const int len = MIN(segment, count - offset);
+        char *chunk = (char*)data + offset;
+        if (tree->parent != -1) {
+            ASSERT_MIMPI_RECV_OK(MIMPI_recv_in(tree->context, chunk, len, tree->parent, GROUP_END));
+        }
+        for (int i = 0; i < tree->child_count; i++) {
+            MIMPI_send_in(tree->context, chunk, len, tree->children[i], GROUP_END);
+        }
+        offset += len;
+    } while (offset < count);
+    return MIMPI_SUCCESS;
+}
+
+static MIMPI_Retcode MIMPI_scatter_allgather_bcast(char *data, int count, int root); // with the scatters
+
+// whether a broadcast of count bytes over the world goes by scatter and allgather
+inline static bool MIMPI_scatter_bcast_suits(int count) {
+    return count >= BCAST_SCATTER_THRESHOLD && world_size > 2;
+}
+
+MIMPI_Retcode MIMPI_Bcast(
+    void *data,
+    int count,
+    int root
+) {
+    MIMPI_collectives_flush();
+    if (root < 0 || root >= world_size)
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    if (MIMPI_scatter_bcast_suits(count)) {
+        return MIMPI_scatter_allgather_bcast(data, count, root);
+    }
+    MIMPI_Tree tree = MIMPI_heap_tree(root);
+    return MIMPI_tree_bcast(&tree, data, count);
+}
+
+inline static void reduce_data(char *dest, char *src, int count, const MIMPI_Op op) {
+    for (int i = 0; i < count; i++) {
+        if (op == MIMPI_MAX) 
+            dest[i] = MAX(dest[i], src[i]);
+        else if (op == MIMPI_MIN) 
+            dest[i] = MIN(dest[i], src[i]);
+        else if (op == MIMPI_SUM)
+            dest[i] += src[i];
+        else 
+            dest[i] *= src[i];
+    }
+    return;
+}
+
+// a buffer for count bytes of data, with a spare byte so that 0 bytes work too;
+// the size is computed in size_t, as count + 1 overflows int for INT_MAX
+static char *MIMPI_byte_buffer(int count) {
+    char *buf = malloc((size_t)count + 1);
+    ASSERT_NOT_NULL(buf);
+    return buf;
+}
+
+// Scratch space MIMPI_tree_reduce needs in this process: the partial result
+// (unless this is the root, which reduces right into recv_data) and a segment
+// of a child's data. Leaves send their data as they are and need none,
+// then NULL is returned.
+static char *MIMPI_tree_reduce_scratch(MIMPI_Tree const *tree, int count) {
+    if (tree->child_count == 0) {
+        return NULL;
+    }
+    size_t size = MIMPI_pipeline_segment(count, reduce_segment);
+    if (tree->parent != -1) {
+        size += (size_t)count;
+    }
+    char *scratch = malloc(size);
+    ASSERT_NOT_NULL(scratch);
+    return scratch;
+}
+
+// scratch comes from MIMPI_tree_reduce_scratch for the same tree and count.
+// Data go up in segments like in MIMPI_tree_bcast, so a segment is reduced
+// while children already send the next one.
+static MIMPI_Retcode MIMPI_tree_reduce(
+    MIMPI_Tree const *tree,
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Op op,
+    char *scratch
+) {
+    char *reduced_data = (char*)send_data; // only read when there are no children
+    char *tmp_buf = scratch;
+    if (tree->parent == -1 || tree->child_count > 0) {
+        reduced_data = (tree->parent == -1 ? recv_data : scratch);
+        tmp_buf = (tree->parent == -1 ? scratch : scratch + count);
+        if (reduced_data != send_data) {
+            memcpy(reduced_data, send_data, count);
+        }
+    }
+
+    const int segment = MIMPI_pipeline_segment(count, reduce_segment);
+    int offset = 0;
+    do {
+        const int len = MIN(segment, count - offset);
+        for (int i = 0; i < tree->child_count; i++) {
+            ASSERT_MIMPI_RECV_OK(MIMPI_recv_in(tree->context, tmp_buf, len, tree->children[i], GROUP_BEGIN));
+            reduce_data(reduced_data + offset, tmp_buf, len, op);
+        }
+        if (tree->parent != -1) {
+            MIMPI_send_in(tree->context, reduced_data + offset, len, tree->parent, GROUP_BEGIN);
+        }
+        offset += len;
+    } while (offset < count);
+
+    if (tree->parent != -1) {
+        ASSERT_MIMPI_RECV_OK(MIMPI_recv_in(tree->context, NULL, 0, tree->parent, GROUP_END));
+    }
+    for (int i = 0; i < tree->child_count; i++) {
+        MIMPI_send_in(tree->context, NULL, 0, tree->children[i], GROUP_END);
+    }
+    return MIMPI_SUCCESS;
+}
+
+// MIMPI_tree_reduce with its scratch space
+static MIMPI_Retcode MIMPI_reduce_on_tree(
+    MIMPI_Tree const *tree,
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Op op
+) {
+    char *scratch = MIMPI_tree_reduce_scratch(tree, count);
+    MIMPI_Retcode res = MIMPI_tree_reduce(tree, send_data, recv_data, count, op, scratch);
+    free(scratch);
+    return res;
+}
+
+static MIMPI_Retcode MIMPI_rabenseifner_reduce(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Op op,
+    int root
+); // with the reduce-scatters
+
+// whether a reduction of count bytes over the world goes with Rabenseifner's
+// algorithm; by default it doesn't, as it was slower than the pipelined tree
+inline static bool MIMPI_rabenseifner_suits(int count) {
+    return reduce_rabenseifner > 0 && count >= reduce_rabenseifner && world_size > 2;
+}
+
+MIMPI_Retcode MIMPI_Reduce(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Op op,
+    int root
+) {
+    MIMPI_collectives_flush();
+    if (root < 0 || root >= world_size)
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    if (MIMPI_rabenseifner_suits(count)) {
+        return MIMPI_rabenseifner_reduce(send_data, recv_data, count, op, root);
+    }
+    MIMPI_Tree tree = MIMPI_heap_tree(root);
+    return MIMPI_reduce_on_tree(&tree, send_data, recv_data, count, op);
+}
+
+// start of i-th out of world_size nearly equal blocks of count bytes
+inline static int MIMPI_block_start(int count, int i) {
+    return (int)((long long)count * i / world_size);
+}
+
+// Reduce-scatter around the ring: block i lies at data[displs[i]..displs[i+1])
+// and ends up fully reduced in process i. Other blocks are left partial.
+static MIMPI_Retcode MIMPI_ring_reduce_scatter(
+    char *data,
+    int const *displs,
+    MIMPI_Op op,
+    char *tmp_buf
+) {
+    const int left = (my_rank + world_size - 1) % world_size;
+    const int right = (my_rank + 1) % world_size;
+
+    for (int step = 0; step < world_size - 1; step++) {
+        const int send_block = (my_rank - step - 1 + 2*world_size) % world_size;
+        const int recv_block = (my_rank - step - 2 + 2*world_size) % world_size;
+        const int recv_len = displs[recv_block+1] - displs[recv_block];
+
+        MIMPI_Send(data + displs[send_block], displs[send_block+1] - displs[send_block],
+                   right, GROUP_BEGIN);
+        ASSERT_MIMPI_RECV_OK(MIMPI_Recv(tmp_buf, recv_len, left, GROUP_BEGIN));
+        reduce_data(data + displs[recv_block], tmp_buf, recv_len, op);
+    }
+    return MIMPI_SUCCESS;
+}
+
+// Allgather around the ring: process i starts with block i (laid out as in
+// MIMPI_ring_reduce_scatter), everyone ends with all of them.
+static MIMPI_Retcode MIMPI_ring_allgather(char *data, int const *displs) {
+    const int left = (my_rank + world_size - 1) % world_size;
+    const int right = (my_rank + 1) % world_size;
+
+    for (int step = 0; step < world_size - 1; step++) {
+        const int send_block = (my_rank - step + world_size) % world_size;
+        const int recv_block = (my_rank - step - 1 + world_size) % world_size;
+
+        MIMPI_Send(data + displs[send_block], displs[send_block+1] - displs[send_block],
+                   right, GROUP_BEGIN);
+        ASSERT_MIMPI_RECV_OK(MIMPI_Recv(data + displs[recv_block],
+                             displs[recv_block+1] - displs[recv_block], left, GROUP_BEGIN));
+    }
+    return MIMPI_SUCCESS;
+}
+
+// Reduction up the tree fused with sending the result straight back down,
+// two sweeps instead of four of MIMPI_Reduce followed by MIMPI_Bcast.
+static MIMPI_Retcode MIMPI_tree_allreduce(char *data, int count, MIMPI_Op op) {
+    const int l_child = (my_rank+1)*2-1, r_child = l_child+1;
+    const int parent = (my_rank+1)/2-1;
+
+    if (l_child < world_size) {
+        char *tmp_buf = malloc(count);
+        ASSERT_NOT_NULL(tmp_buf);
+        MIMPI_Retcode res = MIMPI_Recv(tmp_buf, count, l_child, GROUP_BEGIN);
+        if (res == MIMPI_SUCCESS) {
+            reduce_data(data, tmp_buf, count, op);
+            if (r_child < world_size) {
+                res = MIMPI_Recv(tmp_buf, count, r_child, GROUP_BEGIN);
+                if (res == MIMPI_SUCCESS) {
+                    reduce_data(data, tmp_buf, count, op);
+                }
+            }
+        }
+        free(tmp_buf);
+        ASSERT_MIMPI_RECV_OK(res);
+    }
+
+    if (my_rank != 0) {
+        MIMPI_Send(data, count, parent, GROUP_BEGIN);
+        ASSERT_MIMPI_RECV_OK(MIMPI_Recv(data, count, parent, GROUP_END));
+    }
+    if (l_child < world_size) {
+        MIMPI_Send(data, count, l_child, GROUP_END);
+        if (r_child < world_size) {
+            MIMPI_Send(data, count, r_child, GROUP_END);
+        }
+    }
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Allreduce(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Op op
+) {
+    MIMPI_collectives_flush();
+    if (recv_data != send_data) {
+        memcpy(recv_data, send_data, count);
+    }
+
+    if (count < ALLREDUCE_RING_THRESHOLD || world_size <= 2) {
+        return MIMPI_tree_allreduce(recv_data, count, op);
+    }
+
+    int *displs = malloc((world_size + 1) * sizeof(int));
+    char *tmp_buf = malloc(count / world_size + 1);
+    ASSERT_NOT_NULL(displs);
+    ASSERT_NOT_NULL(tmp_buf);
+    for (int i = 0; i <= world_size; i++) {
+        displs[i] = MIMPI_block_start(count, i);
+    }
+
+    MIMPI_Retcode res = MIMPI_ring_reduce_scatter(recv_data, displs, op, tmp_buf);
+    if (res == MIMPI_SUCCESS) {
+        res = MIMPI_ring_allgather(recv_data, displs);
+    }
+    free(tmp_buf);
+    free(displs);
+    return res;
+}
+
+// Binomial trees are built over ranks relative to the root, children of rel
+// are rel + 2^k for every 2^k below the lowest set bit of rel.
+inline static int MIMPI_relative(int rank, int root) {
+    return (rank - root + world_size) % world_size;
+}
+
+inline static int MIMPI_absolute(int rel, int root) {
+    return (rel + root) % world_size;
+}
+
+// lowest set bit of rel, for the root the first power of two >= world_size
+inline static int MIMPI_binomial_mask(int rel) {
+    int mask = 1;
+    while (mask < world_size && !(rel & mask)) {
+        mask <<= 1;
+    }
+    return mask;
+}
+
+// Up-sweep of empty messages, so that a rooted collective is
+// a synchronisation point like the others.
+static MIMPI_Retcode MIMPI_binomial_enter(int root) {
+    const int rel = MIMPI_relative(my_rank, root);
+    const int mask = MIMPI_binomial_mask(rel);
+
+    for (int child = 1; child < mask; child <<= 1) {
+        if (rel + child < world_size) {
+            ASSERT_MIMPI_RECV_OK(MIMPI_Recv(NULL, 0, MIMPI_absolute(rel + child, root), GROUP_BEGIN));
+        }
+    }
+    if (rel != 0) {
+        MIMPI_Send(NULL, 0, MIMPI_absolute(rel - mask, root), GROUP_BEGIN);
+    }
+    return MIMPI_SUCCESS;
+}
+
+// Down-sweep of empty messages, the other half of MIMPI_binomial_enter.
+static MIMPI_Retcode MIMPI_binomial_release(int root) {
+    const int rel = MIMPI_relative(my_rank, root);
+    int mask = MIMPI_binomial_mask(rel);
+
+    if (rel != 0) {
+        ASSERT_MIMPI_RECV_OK(MIMPI_Recv(NULL, 0, MIMPI_absolute(rel - mask, root), GROUP_END));
+    }
+    for (mask >>= 1; mask > 0; mask >>= 1) {
+        if (rel + mask < world_size) {
+            MIMPI_Send(NULL, 0, MIMPI_absolute(rel + mask, root), GROUP_END);
+        }
+    }
+    return MIMPI_SUCCESS;
+}
+
+// receives a group message of any size from source and appends it to *buf
+static MIMPI_Retcode MIMPI_recv_appended(
+    int context,
+    char **buf,
+    int *len,
+    int *capacity,
+    int source,
+    int tag
+) {
+    MIMPI_Message pattern = {.source = source, .tag = tag,
+                             .count = MIMPI_ANY_COUNT, .context = context};
+    MIMPI_Status status;
+    MIMPI_Node *node;
+    MIMPI_Retcode res = MIMPI_wait_message(&pattern, true, &node, &status);
+    if (res != MIMPI_SUCCESS) {
+        return res;
+    }
+
+    if (*len + status.count > *capacity) {
+        *capacity = MAX(*len + status.count, 2 * *capacity);
+        ASSERT_NOT_NULL(*buf = realloc(*buf, *capacity));
+    }
+    MIMPI_consume_message(node, *buf + *len, status.count);
+    *len += status.count;
+    return MIMPI_SUCCESS;
+}
+
+// Each process sends its subtree's data, packed in relative rank order,
+// up the binomial tree. The root unpacks it using recv_counts and displs.
+static MIMPI_Retcode MIMPI_binomial_gather(
+    void const *send_data,
+    int send_count,
+    void *recv_data,
+    int const *recv_counts,
+    int const *displs,
+    int root
+) {
+    const int rel = MIMPI_relative(my_rank, root);
+    const int mask = MIMPI_binomial_mask(rel);
+
+    int len = send_count, capacity = MAX(send_count, 1);
+    char *buf = malloc(capacity);
+    ASSERT_NOT_NULL(buf);
+    memcpy(buf, send_data, send_count);
+
+    MIMPI_Retcode res = MIMPI_SUCCESS;
+    for (int child = 1; child < mask && res == MIMPI_SUCCESS; child <<= 1) {
+        if (rel + child < world_size) {
+            res = MIMPI_recv_appended(world_comm.context, &buf, &len, &capacity,
+                                      MIMPI_absolute(rel + child, root), GROUP_BEGIN);
+        }
+    }
+    if (res != MIMPI_SUCCESS) {
+        free(buf);
+        return res;
+    }
+
+    if (rel != 0) {
+        MIMPI_Send(buf, len, MIMPI_absolute(rel - mask, root), GROUP_BEGIN);
+    }
+    else {
+        for (int i = 0, offset = 0; i < world_size; i++) {
+            const int rank = MIMPI_absolute(i, root);
+            memcpy((char*)recv_data + displs[rank], buf + offset, recv_counts[rank]);
+            offset += recv_counts[rank];
+        }
+    }
+    free(buf);
+
+    return MIMPI_binomial_release(root);
+}
+
+MIMPI_Retcode MIMPI_Gather(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    int root
+) {
+    MIMPI_collectives_flush();
+    if (root < 0 || root >= world_size)
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    int *recv_counts = NULL, *displs = NULL;
+    if (my_rank == root) {
+        ASSERT_NOT_NULL(recv_counts = malloc(world_size * sizeof(int)));
+        ASSERT_NOT_NULL(displs = malloc(world_size * sizeof(int)));
+        for (int i = 0; i < world_size; i++) {
+            recv_counts[i] = count;
+            displs[i] = i * count;
+        }
+    }
+
+    MIMPI_Retcode res = MIMPI_binomial_gather(send_data, count, recv_data,
+                                              recv_counts, displs, root);
+    free(recv_counts);
+    free(displs);
+    return res;
+}
+
+MIMPI_Retcode MIMPI_Gatherv(
+    void const *send_data,
+    int send_count,
+    void *recv_data,
+    int const *recv_counts,
+    int const *displs,
+    int root
+) {
+    MIMPI_collectives_flush();
+    if (root < 0 || root >= world_size)
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    return MIMPI_binomial_gather(send_data, send_count, recv_data,
+                                 recv_counts, displs, root);
+}
+
+// Bruck's allgather: ceil(log2(world_size)) rounds, in each the gathered
+// blocks are doubled. Block i of buf belongs to process my_rank + i.
+static MIMPI_Retcode MIMPI_bruck_allgather(void const *send_data, void *recv_data, int count) {
+    char *buf = malloc((size_t)world_size * count + 1);
+    ASSERT_NOT_NULL(buf);
+    memcpy(buf, send_data, count);
+
+    for (int dist = 1; dist < world_size; dist <<= 1) {
+        const int blocks = MIN(dist, world_size - dist);
+        MIMPI_Send(buf, blocks * count, (my_rank - dist + world_size) % world_size, GROUP_BEGIN);
+        MIMPI_Retcode res = MIMPI_Recv(buf + dist * count, blocks * count,
+                                       (my_rank + dist) % world_size, GROUP_BEGIN);
+        if (res == MIMPI_ERROR_REMOTE_FINISHED) {
+            free(buf);
+            return res;
+        }
+    }
+
+    const int head = world_size - my_rank;
+    memcpy((char*)recv_data + my_rank * count, buf, head * count);
+    memcpy(recv_data, buf + head * count, my_rank * count);
+    free(buf);
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Allgather(
+    void const *send_data,
+    void *recv_data,
+    int count
+) {
+    MIMPI_collectives_flush();
+    if ((long long)count * world_size < ALLGATHER_RING_THRESHOLD) {
+        return MIMPI_bruck_allgather(send_data, recv_data, count);
+    }
+
+    int *displs = malloc((world_size + 1) * sizeof(int));
+    ASSERT_NOT_NULL(displs);
+    for (int i = 0; i <= world_size; i++) {
+        displs[i] = i * count;
+    }
+    memcpy((char*)recv_data + displs[my_rank], send_data, count);
+
+    MIMPI_Retcode res = MIMPI_ring_allgather(recv_data, displs);
+    free(displs);
+    return res;
+}
+
+// The root sends each child the slices of its whole subtree, which forwards
+// them further down the binomial tree. A message holds counts of the subtree's
+// processes in relative rank order, followed by their data.
+static MIMPI_Retcode MIMPI_binomial_scatter(
+    void const *send_data,
+    int const *send_counts,
+    int const *displs,
+    void *recv_data,
+    int recv_count,
+    int root
+) {
+    MIMPI_Retcode res = MIMPI_binomial_enter(root);
+    if (res != MIMPI_SUCCESS) {
+        return res;
+    }
+
+    const int rel = MIMPI_relative(my_rank, root);
+    const int mask = MIMPI_binomial_mask(rel);
+    const int subtree = MIN(mask, world_size - rel);
+
+    // counts and data of subtree's processes, indexed by relative rank - rel
+    int *counts;
+    char **blocks;
+    char *buf = NULL;
+    ASSERT_NOT_NULL(blocks = malloc(subtree * sizeof(char*)));
+    if (rel == 0) {
+        ASSERT_NOT_NULL(counts = malloc(subtree * sizeof(int)));
+        for (int i = 0; i < subtree; i++) {
+            const int rank = MIMPI_absolute(i, root);
+            counts[i] = send_counts[rank];
+            blocks[i] = (char*)send_data + displs[rank];
+        }
+    }
+    else {
+        MIMPI_Message pattern = {.source = MIMPI_absolute(rel - mask, root),
+                                 .tag = GROUP_END, .count = MIMPI_ANY_COUNT};
+        MIMPI_Status status;
+        MIMPI_Node *node;
+        res = MIMPI_wait_message(&pattern, true, &node, &status);
+        if (res != MIMPI_SUCCESS) {
+            free(blocks);
+            return res;
+        }
+        ASSERT_NOT_NULL(buf = malloc(status.count));
+        MIMPI_consume_message(node, buf, status.count);
+
+        counts = (int*)buf;
+        blocks[0] = buf + subtree * sizeof(int);
+        for (int i = 1; i < subtree; i++) {
+            blocks[i] = blocks[i-1] + counts[i-1];
+        }
+    }
+
+    for (int child = mask >> 1; child > 0; child >>= 1) {
+        if (rel + child >= world_size) {
+            continue;
+        }
+        const int child_subtree = MIN(child, world_size - rel - child);
+        struct iovec iov[child_subtree + 1];
+        iov[0].iov_base = counts + child;
+        iov[0].iov_len = child_subtree * sizeof(int);
+        for (int i = 0; i < child_subtree; i++) {
+            iov[i+1].iov_base = blocks[child + i];
+            iov[i+1].iov_len = counts[child + i];
+        }
+        MIMPI_Sendv(iov, child_subtree + 1, MIMPI_absolute(rel + child, root), GROUP_END);
+    }
+
+    memmove(recv_data, blocks[0], MIN(counts[0], recv_count)); // the same place for bcast's root
+    res = (counts[0] > recv_count ? MIMPI_ERROR_TRUNCATED : MIMPI_SUCCESS);
+    if (rel == 0) {
+        free(counts);
+    }
+    free(blocks);
+    free(buf);
+    return res;
+}
+
+// Van de Geijn's broadcast: the root scatters data in world_size blocks,
+// which are then gathered by everyone around the ring. Each process sends
+// about twice the data's size in total, regardless of world_size.
+static MIMPI_Retcode MIMPI_scatter_allgather_bcast(char *data, int count, int root) {
+    int *displs = malloc((world_size + 1) * sizeof(int));
+    int *counts = malloc(world_size * sizeof(int));
+    ASSERT_NOT_NULL(displs);
+    ASSERT_NOT_NULL(counts);
+    for (int i = 0; i <= world_size; i++) {
+        displs[i] = MIMPI_block_start(count, i);
+    }
+    for (int i = 0; i < world_size; i++) {
+        counts[i] = displs[i+1] - displs[i];
+    }
+
+    MIMPI_Retcode res = MIMPI_binomial_scatter(data, counts, displs, data + displs[my_rank],
+                                               counts[my_rank], root);
+    if (res == MIMPI_SUCCESS) {
+        res = MIMPI_ring_allgather(data, displs);
+    }
+    free(counts);
+    free(displs);
+    return res;
+}
+
+MIMPI_Retcode MIMPI_Scatter(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    int root
+) {
+    MIMPI_collectives_flush();
+    if (root < 0 || root >= world_size)
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    int *send_counts = NULL, *displs = NULL;
+    if (my_rank == root) {
+        ASSERT_NOT_NULL(send_counts = malloc(world_size * sizeof(int)));
+        ASSERT_NOT_NULL(displs = malloc(world_size * sizeof(int)));
+        for (int i = 0; i < world_size; i++) {
+            send_counts[i] = count;
+            displs[i] = i * count;
+        }
+    }
+
+    MIMPI_Retcode res = MIMPI_binomial_scatter(send_data, send_counts, displs,
+                                               recv_data, count, root);
+    free(send_counts);
+    free(displs);
+    return res;
+}
+
+MIMPI_Retcode MIMPI_Scatterv(
+    void const *send_data,
+    int const *send_counts,
+    int const *displs,
+    void *recv_data,
+    int recv_count,
+    int root
+) {
+    MIMPI_collectives_flush();
+    if (root < 0 || root >= world_size)
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    return MIMPI_binomial_scatter(send_data, send_counts, displs,
+                                  recv_data, recv_count, root);
+}
+
+inline static double MIMPI_now() {
+    struct timespec now;
+    ASSERT_SYS_OK(clock_gettime(CLOCK_MONOTONIC, &now));
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Bruck's alltoall: blocks are rotated by my_rank, in the round for bit dist
+// every block whose index has it set moves dist processes further, then the
+// blocks are rotated back. Only ceil(log2(world_size)) messages are sent.
+static MIMPI_Retcode MIMPI_bruck_alltoall(void const *send_data, void *recv_data, int count) {
+    char *buf = malloc((size_t)world_size * count + 1);
+    ASSERT_NOT_NULL(buf);
+    for (int i = 0; i < world_size; i++) {
+        memcpy(buf + i * count, (char*)send_data + ((my_rank + i) % world_size) * count, count);
+    }
+
+    struct iovec iov[16];
+    for (int dist = 1; dist < world_size; dist <<= 1) {
+        const double start = MIMPI_now();
+        int iovcnt = 0;
+        for (int i = dist; i < world_size; i++) {
+            if (i & dist) {
+                iov[iovcnt].iov_base = buf + i * count;
+                iov[iovcnt++].iov_len = count;
+            }
+        }
+        MIMPI_Sendv(iov, iovcnt, (my_rank + dist) % world_size, GROUP_BEGIN);
+        MIMPI_Retcode res = MIMPI_Recvv(iov, iovcnt, (my_rank - dist + world_size) % world_size,
+                                        GROUP_BEGIN);
+        if (res == MIMPI_ERROR_REMOTE_FINISHED) {
+            free(buf);
+            return res;
+        }
+        alltoall_step_times[alltoall_steps++] = MIMPI_now() - start;
+    }
+
+    for (int i = 0; i < world_size; i++) {
+        memcpy((char*)recv_data + ((my_rank - i + world_size) % world_size) * count,
+               buf + i * count, count);
+    }
+    free(buf);
+    return MIMPI_SUCCESS;
+}
+
+// In step s every process sends to my_rank + s and receives from my_rank - s,
+// so every link is used exactly once per step.
+static MIMPI_Retcode MIMPI_pairwise_alltoall(
+    void const *send_data,
+    int const *send_counts,
+    int const *send_displs,
+    void *recv_data,
+    int const *recv_counts,
+    int const *recv_displs
+) {
+    memcpy((char*)recv_data + recv_displs[my_rank], (char*)send_data + send_displs[my_rank],
+           MIN(send_counts[my_rank], recv_counts[my_rank]));
+
+    for (int step = 1; step < world_size; step++) {
+        const double start = MIMPI_now();
+        const int destination = (my_rank + step) % world_size;
+        const int source = (my_rank - step + world_size) % world_size;
+        MIMPI_Send((char*)send_data + send_displs[destination], send_counts[destination],
+                   destination, GROUP_BEGIN);
+        ASSERT_MIMPI_RECV_OK(MIMPI_Recv((char*)recv_data + recv_displs[source], recv_counts[source],
+                                        source, GROUP_BEGIN));
+        alltoall_step_times[alltoall_steps++] = MIMPI_now() - start;
+    }
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Alltoall(
+    void const *send_data,
+    void *recv_data,
+    int count
+) {
+    MIMPI_collectives_flush();
+    alltoall_steps = 0;
+    if (count < ALLTOALL_BRUCK_THRESHOLD) {
+        return MIMPI_bruck_alltoall(send_data, recv_data, count);
+    }
+
+    int counts[16], displs[16];
+    for (int i = 0; i < world_size; i++) {
+        counts[i] = count;
+        displs[i] = i * count;
+    }
+    return MIMPI_pairwise_alltoall(send_data, counts, displs, recv_data, counts, displs);
+}
+
+MIMPI_Retcode MIMPI_Alltoallv(
+    void const *send_data,
+    int const *send_counts,
+    int const *send_displs,
+    void *recv_data,
+    int const *recv_counts,
+    int const *recv_displs
+) {
+    MIMPI_collectives_flush();
+    alltoall_steps = 0;
+    return MIMPI_pairwise_alltoall(send_data, send_counts, send_displs,
+                                   recv_data, recv_counts, recv_displs);
+}
+
+MIMPI_Retcode MIMPI_Alltoall_timing(double *step_times, int max_steps, int *steps) {
+    memcpy(step_times, alltoall_step_times, MIN(max_steps, alltoall_steps) * sizeof(double));
+    *steps = alltoall_steps;
+    return MIMPI_SUCCESS;
+}
+
+// Recursive doubling: after the round for dist, window holds the reduction
+// over processes my_rank - 2*dist + 1 ... my_rank. exclusive, if given, gets
+// the same without my_rank's own data.
+static MIMPI_Retcode MIMPI_recursive_scan(
+    char *window,
+    char *exclusive,
+    int count,
+    MIMPI_Op op
+) {
+    char *tmp_buf = MIMPI_byte_buffer(count);
+
+    for (int dist = 1; dist < world_size; dist <<= 1) {
+        if (my_rank + dist < world_size) {
+            MIMPI_Send(window, count, my_rank + dist, GROUP_BEGIN);
+        }
+        if (my_rank - dist >= 0) {
+            MIMPI_Retcode res = MIMPI_Recv(tmp_buf, count, my_rank - dist, GROUP_BEGIN);
+            if (res == MIMPI_ERROR_REMOTE_FINISHED) {
+                free(tmp_buf);
+                return res;
+            }
+            reduce_data(window, tmp_buf, count, op);
+            if (exclusive != NULL && dist == 1) {
+                memcpy(exclusive, tmp_buf, count);
+            }
+            else if (exclusive != NULL) {
+                reduce_data(exclusive, tmp_buf, count, op);
+            }
+        }
+    }
+    free(tmp_buf);
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Scan(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Op op
+) {
+    MIMPI_collectives_flush();
+    if (recv_data != send_data) {
+        memcpy(recv_data, send_data, count);
+    }
+    return MIMPI_recursive_scan(recv_data, NULL, count, op);
+}
+
+MIMPI_Retcode MIMPI_Exscan(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Op op
+) {
+    MIMPI_collectives_flush();
+    char *window = MIMPI_byte_buffer(count);
+    memcpy(window, send_data, count);
+
+    MIMPI_Retcode res = MIMPI_recursive_scan(window, recv_data, count, op);
+    free(window);
+    return res;
+}
+
+// Recursive halving among size processes, size being a power of two: in the
+// round for mask, processes differing in that bit exchange halves of the
+// blocks they are still responsible for. Process number i is ranks[i] and this
+// one is number rank. Layout and result are as in MIMPI_ring_reduce_scatter.
+static MIMPI_Retcode MIMPI_halving_reduce_scatter(
+    char *data,
+    int const *displs,
+    MIMPI_Op op,
+    char *tmp_buf,
+    int const *ranks,
+    int size,
+    int rank
+) {
+    int low = 0, high = size;
+    for (int mask = size >> 1; mask > 0; mask >>= 1) {
+        const int partner = ranks[rank ^ mask];
+        const int mid = low + mask;
+        int keep_low = low, keep_high = mid, give_low = mid, give_high = high;
+        if (rank & mask) {
+            keep_low = mid, keep_high = high, give_low = low, give_high = mid;
+        }
+        const int keep_len = displs[keep_high] - displs[keep_low];
+
+        MIMPI_Send(data + displs[give_low], displs[give_high] - displs[give_low],
+                   partner, GROUP_BEGIN);
+        ASSERT_MIMPI_RECV_OK(MIMPI_Recv(tmp_buf, keep_len, partner, GROUP_BEGIN));
+        reduce_data(data + displs[keep_low], tmp_buf, keep_len, op);
+        low = keep_low, high = keep_high;
+    }
+    return MIMPI_SUCCESS;
+}
+
+// Rabenseifner's reduce: a reduce-scatter by recursive halving and a binomial
+// gather of the reduced blocks, so each process reduces only its share of data.
+// With world_size not a power of two, the first 2 * rest processes pair up
+// beforehand and the even ones hand their data to the odd ones, which take
+// part for both. Only the taking part need a working copy of data (the root
+// works right in recv_data) and a buffer for half of them.
+static MIMPI_Retcode MIMPI_rabenseifner_reduce(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Op op,
+    int root
+) {
+    int size = 1;
+    while (size * 2 <= world_size) {
+        size *= 2;
+    }
+    const int rest = world_size - size;
+    const int half = count / 2;
+
+    if (my_rank < 2 * rest && my_rank % 2 == 0) {
+        MIMPI_Send(send_data, half, my_rank + 1, GROUP_BEGIN);
+        MIMPI_Send((char const*)send_data + half, count - half, my_rank + 1, GROUP_BEGIN);
+        if (my_rank == root) {
+            ASSERT_MIMPI_RECV_OK(MIMPI_Recv(recv_data, count, root + 1, GROUP_BEGIN));
+        }
+        return MIMPI_binomial_release(root);
+    }
+
+    char *data = (my_rank == root ? recv_data : MIMPI_byte_buffer(count));
+    char *tmp_buf = MIMPI_byte_buffer(count - half);
+    if (data != send_data) {
+        memcpy(data, send_data, count);
+    }
+
+    // number of the process among the size taking part
+    int rank = my_rank - rest;
+    MIMPI_Retcode res = MIMPI_SUCCESS;
+    if (my_rank < 2 * rest) {
+        res = MIMPI_Recv(tmp_buf, half, my_rank - 1, GROUP_BEGIN);
+        if (res == MIMPI_SUCCESS) {
+            reduce_data(data, tmp_buf, half, op);
+            res = MIMPI_Recv(tmp_buf, count - half, my_rank - 1, GROUP_BEGIN);
+        }
+        if (res == MIMPI_SUCCESS) {
+            reduce_data(data + half, tmp_buf, count - half, op);
+        }
+        rank = my_rank / 2;
+    }
+
+    int *ranks = malloc(size * sizeof(int));
+    int *displs = malloc((size + 1) * sizeof(int));
+    ASSERT_NOT_NULL(ranks);
+    ASSERT_NOT_NULL(displs);
+    for (int i = 0; i < size; i++) {
+        ranks[i] = (i < rest ? 2 * i + 1 : i + rest);
+    }
+    for (int i = 0; i <= size; i++) {
+        displs[i] = (int)((long long)count * i / size);
+    }
+
+    if (res == MIMPI_SUCCESS) {
+        res = MIMPI_halving_reduce_scatter(data, displs, op, tmp_buf, ranks, size, rank);
+    }
+
+    // blocks gather in the process standing for the root, in the reverse
+    // order of the halving: groups of mask blocks merge into groups of 2 * mask
+    const int target = (root < 2 * rest ? root / 2 : root - rest);
+    for (int mask = 1; mask < size && res == MIMPI_SUCCESS; mask <<= 1) {
+        const int low = rank & ~(mask - 1), partner_low = (rank ^ mask) & ~(mask - 1);
+        if ((rank ^ target) & mask) {
+            MIMPI_Send(data + displs[low], displs[low + mask] - displs[low],
+                       ranks[rank ^ mask], GROUP_BEGIN);
+            break;
+        }
+        res = MIMPI_Recv(data + displs[partner_low],
+                         displs[partner_low + mask] - displs[partner_low],
+                         ranks[rank ^ mask], GROUP_BEGIN);
+    }
+    if (res == MIMPI_SUCCESS && rank == target && my_rank != root) {
+        MIMPI_Send(data, count, root, GROUP_BEGIN);
+    }
+
+    free(ranks);
+    free(displs);
+    free(tmp_buf);
+    if (data != recv_data) {
+        free(data);
+    }
+    if (res != MIMPI_SUCCESS) {
+        return res;
+    }
+    return MIMPI_binomial_release(root);
+}
+
+MIMPI_Retcode MIMPI_Reduce_scatter(
+    void const *send_data,
+    void *recv_data,
+    int const *recv_counts,
+    MIMPI_Op op
+) {
+    MIMPI_collectives_flush();
+    int *displs = malloc((world_size + 1) * sizeof(int));
+    ASSERT_NOT_NULL(displs);
+    displs[0] = 0;
+    for (int i = 0; i < world_size; i++) {
+        displs[i+1] = displs[i] + recv_counts[i];
+    }
+    const int count = displs[world_size];
+
+    char *data = MIMPI_byte_buffer(count);
+    char *tmp_buf = MIMPI_byte_buffer(count);
+    memcpy(data, send_data, count);
+
+    MIMPI_Retcode res;
+    if ((world_size & (world_size - 1)) == 0) {
+        res = MIMPI_halving_reduce_scatter(data, displs, op, tmp_buf,
+                                           world_comm.ranks, world_size, my_rank);
+    }
+    else {
+        res = MIMPI_ring_reduce_scatter(data, displs, op, tmp_buf);
+    }
+    if (res == MIMPI_SUCCESS) {
+        memcpy(recv_data, data + displs[my_rank], recv_counts[my_rank]);
+    }
+
+    free(tmp_buf);
+    free(data);
+    free(displs);
+    return res;
+}
+
+MIMPI_Retcode MIMPI_Reduce_scatter_block(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Op op
+) {
+    int *recv_counts = malloc(world_size * sizeof(int));
+    ASSERT_NOT_NULL(recv_counts);
+    for (int i = 0; i < world_size; i++) {
+        recv_counts[i] = count;
+    }
+
+    MIMPI_Retcode res = MIMPI_Reduce_scatter(send_data, recv_data, recv_counts, op);
+    free(recv_counts);
+    return res;
+}
 
-    char *reduced_data;
-    if (treat_as == 0) {
-        reduced_data = recv_data;
-    } else {
-        ASSERT_NOT_NULL(reduced_data = malloc(count));
+static MIMPI_Retcode MIMPI_perform_collective(MIMPI_Request req) {
+    if (req->persistent && req->collective == MIMPI_COLL_BCAST) {
+        if (MIMPI_scatter_bcast_suits(req->count)) {
+            return MIMPI_scatter_allgather_bcast(req->data, req->count, req->root);
+        }
+        return MIMPI_tree_bcast(&req->tree, req->data, req->count);
+    }
+    if (req->persistent && req->collective == MIMPI_COLL_REDUCE) {
+        if (MIMPI_rabenseifner_suits(req->count)) {
+            return MIMPI_rabenseifner_reduce(req->send_data, req->data,
+                                             req->count, req->op, req->root);
+        }
+        return MIMPI_tree_reduce(&req->tree, req->send_data, req->data,
+                                 req->count, req->op, req->scratch);
     }
-    ;
-    memcpy(reduced_data, send_data, count);
 
-    if (l_child < world_size) {
-        char *tmp_buf = malloc(count);
-        ASSERT_MIMPI_RECV_OK(MIMPI_Recv(tmp_buf, count, l_child, GROUP_BEGIN));
-        reduce_data(reduced_data, tmp_buf, count, op);
-        if (r_child < world_size) {
-            ASSERT_MIMPI_RECV_OK(MIMPI_Recv(tmp_buf, count, r_child, GROUP_BEGIN));
-            reduce_data(reduced_data, tmp_buf, count, op);
+    switch (req->collective) {
+        case MIMPI_COLL_BARRIER:
+            return MIMPI_Barrier();
+        case MIMPI_COLL_BCAST:
+            return MIMPI_Bcast(req->data, req->count, req->root);
+        case MIMPI_COLL_REDUCE:
+            return MIMPI_Reduce(req->send_data, req->data, req->count, req->op, req->root);
+    }
+    return MIMPI_SUCCESS;
+}
+
+static void* MIMPI_Collective_progress(void* arg) {
+    ASSERT_ZERO(pthread_mutex_lock(&coll.mutex));
+    while (true) {
+        while (coll.head == NULL && !coll.stopping) {
+            ASSERT_ZERO(pthread_cond_wait(&coll.changed, &coll.mutex));
         }
-        free(tmp_buf);
+        if (coll.head == NULL) {
+            break;
+        }
+
+        MIMPI_Request req = coll.head;
+        ASSERT_ZERO(pthread_mutex_unlock(&coll.mutex));
+        MIMPI_Retcode res = MIMPI_perform_collective(req);
+        ASSERT_ZERO(pthread_mutex_lock(&coll.mutex));
+
+        req->result = res;
+        req->finished = true;
+        coll.head = req->next_queued;
+        if (coll.head == NULL) {
+            coll.tail = NULL;
+        }
+        ASSERT_ZERO(pthread_cond_broadcast(&coll.changed));
     }
+    ASSERT_ZERO(pthread_mutex_unlock(&coll.mutex));
+    return NULL;
+}
 
-    if (treat_as != 0) {
-        MIMPI_Send(reduced_data, count, parent, GROUP_BEGIN);
-        free(reduced_data);
-        ASSERT_MIMPI_RECV_OK(MIMPI_Recv(NULL, 0, parent, GROUP_END));
+// queues a collective for the progress thread, starting it if needed
+static void MIMPI_queue_collective(MIMPI_Request req) {
+    req->active = true;
+    req->finished = false;
+    req->next_queued = MIMPI_REQUEST_NULL;
+
+    ASSERT_ZERO(pthread_mutex_lock(&coll.mutex));
+    if (!coll.started) {
+        coll.started = true;
+        ASSERT_ZERO(pthread_create(&coll.thread, NULL, MIMPI_Collective_progress, NULL));
+    }
+    if (coll.tail != NULL) {
+        coll.tail->next_queued = req;
     }
+    else {
+        coll.head = req;
+    }
+    coll.tail = req;
+    ASSERT_ZERO(pthread_cond_broadcast(&coll.changed));
+    ASSERT_ZERO(pthread_mutex_unlock(&coll.mutex));
+}
 
-    if (l_child < world_size) {
-        MIMPI_Send(NULL, 0, l_child, GROUP_END);
-        if(r_child < world_size) {
-            MIMPI_Send(NULL, 0, r_child, GROUP_END);
+inline static MIMPI_Request MIMPI_new_collective(MIMPI_Collective collective) {
+    MIMPI_Request req = calloc(1, sizeof(struct MIMPI_Request_data));
+    ASSERT_NOT_NULL(req);
+    req->kind = MIMPI_REQUEST_COLL;
+    req->collective = collective;
+    return req;
+}
+
+MIMPI_Retcode MIMPI_Ibarrier(MIMPI_Request *request) {
+    MIMPI_Request req = MIMPI_new_collective(MIMPI_COLL_BARRIER);
+    MIMPI_queue_collective(req);
+    *request = req;
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Ibcast(
+    void *data,
+    int count,
+    int root,
+    MIMPI_Request *request
+) {
+    if (root < 0 || root >= world_size)
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    MIMPI_Request req = MIMPI_new_collective(MIMPI_COLL_BCAST);
+    req->data = data;
+    req->count = count;
+    req->root = root;
+    MIMPI_queue_collective(req);
+    *request = req;
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Ireduce(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Op op,
+    int root,
+    MIMPI_Request *request
+) {
+    if (root < 0 || root >= world_size)
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    MIMPI_Request req = MIMPI_new_collective(MIMPI_COLL_REDUCE);
+    req->send_data = send_data;
+    req->data = recv_data;
+    req->count = count;
+    req->op = op;
+    req->root = root;
+    MIMPI_queue_collective(req);
+    *request = req;
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Bcast_init(
+    void *data,
+    int count,
+    int root,
+    MIMPI_Request *request
+) {
+    if (root < 0 || root >= world_size)
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    MIMPI_Request req = MIMPI_new_collective(MIMPI_COLL_BCAST);
+    req->persistent = true;
+    req->tree = MIMPI_heap_tree(root);
+    req->data = data;
+    req->count = count;
+    req->root = root;
+    *request = req;
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Reduce_init(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Op op,
+    int root,
+    MIMPI_Request *request
+) {
+    if (root < 0 || root >= world_size)
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    MIMPI_Request req = MIMPI_new_collective(MIMPI_COLL_REDUCE);
+    req->persistent = true;
+    req->tree = MIMPI_heap_tree(root);
+    if (!MIMPI_rabenseifner_suits(count)) {
+        req->scratch = MIMPI_tree_reduce_scratch(&req->tree, count);
+    }
+    req->send_data = send_data;
+    req->data = recv_data;
+    req->count = count;
+    req->op = op;
+    req->root = root;
+    *request = req;
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Barrier_begin() {
+    if (split_barrier != MIMPI_REQUEST_NULL) {
+        MIMPI_Wait(&split_barrier);
+    }
+    return MIMPI_Ibarrier(&split_barrier);
+}
+
+MIMPI_Retcode MIMPI_Barrier_end() {
+    return MIMPI_Wait(&split_barrier);
+}
+
+inline static MIMPI_Topology MIMPI_new_topology(int indegree, int outdegree) {
+    MIMPI_Topology topology = calloc(1, sizeof(struct MIMPI_Topology_data));
+    ASSERT_NOT_NULL(topology);
+    topology->indegree = indegree;
+    topology->outdegree = outdegree;
+    ASSERT_NOT_NULL(topology->sources = malloc((indegree + 1) * sizeof(int)));
+    ASSERT_NOT_NULL(topology->recv_tags = malloc((indegree + 1) * sizeof(int)));
+    ASSERT_NOT_NULL(topology->destinations = malloc((outdegree + 1) * sizeof(int)));
+    ASSERT_NOT_NULL(topology->send_tags = malloc((outdegree + 1) * sizeof(int)));
+    return topology;
+}
+
+MIMPI_Retcode MIMPI_Cart_create(
+    int ndims,
+    int const *dims,
+    bool const *periods,
+    bool reorder,
+    MIMPI_Topology *topology
+) {
+    int size = 1;
+    for (int d = 0; d < ndims; d++) {
+        if (dims[d] <= 0) 
+            {return MIMPI_ERROR_INVALID_TOPOLOGY;}
+        size *= dims[d];
+    }
+    if (ndims < 0 || 2 * ndims > NEIGHBOR_SLOTS || size != world_size) 
+        {return MIMPI_ERROR_INVALID_TOPOLOGY;}
+
+    // all processes talk over equally fast pipes, so there's nothing
+    // to gain by reordering and rank in the grid is the world rank
+    (void)reorder;
+
+    MIMPI_Topology topo = MIMPI_new_topology(2 * ndims, 2 * ndims);
+    topo->ndims = ndims;
+    ASSERT_NOT_NULL(topo->dims = malloc((ndims + 1) * sizeof(int)));
+    ASSERT_NOT_NULL(topo->periods = malloc((ndims + 1) * sizeof(bool)));
+    memcpy(topo->dims, dims, ndims * sizeof(int));
+    memcpy(topo->periods, periods, ndims * sizeof(bool));
+
+    // slot 2d is the neighbour one step down dimension d, slot 2d+1 one step up,
+    // a message to the one below lands in its slot for the one above and vice versa
+    int coords[NEIGHBOR_SLOTS / 2];
+    MIMPI_Cart_coords(topo, my_rank, coords);
+    for (int d = 0, stride = size; d < ndims; d++) {
+        stride /= dims[d];
+        for (int dir = 0; dir < 2; dir++) {
+            const int slot = 2 * d + dir;
+            int coord = coords[d] + (dir == 0 ? -1 : 1);
+            if (periods[d]) {
+                coord = (coord + dims[d]) % dims[d];
+            }
+            int neighbor = MIMPI_PROC_NULL;
+            if (coord >= 0 && coord < dims[d]) {
+                neighbor = my_rank + (coord - coords[d]) * stride;
+            }
+            topo->sources[slot] = topo->destinations[slot] = neighbor;
+            topo->recv_tags[slot] = NEIGHBOR_TAG(slot);
+            topo->send_tags[slot] = NEIGHBOR_TAG(2 * d + 1 - dir);
+        }
+    }
+
+    *topology = topo;
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Cart_coords(MIMPI_Topology topology, int rank, int *coords) {
+    if (topology->ndims == 0) 
+        {return MIMPI_ERROR_INVALID_TOPOLOGY;}
+    if (rank < 0 || rank >= world_size) 
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    // the last dimension changes fastest
+    for (int d = topology->ndims - 1; d >= 0; d--) {
+        coords[d] = rank % topology->dims[d];
+        rank /= topology->dims[d];
+    }
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Dist_graph_create(
+    int indegree,
+    int const *sources,
+    int outdegree,
+    int const *destinations,
+    bool reorder,
+    MIMPI_Topology *topology
+) {
+    if (indegree < 0 || outdegree < 0) 
+        {return MIMPI_ERROR_INVALID_TOPOLOGY;}
+    for (int i = 0; i < indegree; i++) {
+        if (sources[i] < 0 || sources[i] >= world_size) 
+            {return MIMPI_ERROR_NO_SUCH_RANK;}
+    }
+    for (int i = 0; i < outdegree; i++) {
+        if (destinations[i] < 0 || destinations[i] >= world_size) 
+            {return MIMPI_ERROR_NO_SUCH_RANK;}
+    }
+    (void)reorder; // see MIMPI_Cart_create
+
+    // repeated edges between two processes are matched in order
+    MIMPI_Topology topo = MIMPI_new_topology(indegree, outdegree);
+    memcpy(topo->sources, sources, indegree * sizeof(int));
+    memcpy(topo->destinations, destinations, outdegree * sizeof(int));
+    for (int i = 0; i < indegree; i++) {
+        topo->recv_tags[i] = NEIGHBOR_TAG(0);
+    }
+    for (int i = 0; i < outdegree; i++) {
+        topo->send_tags[i] = NEIGHBOR_TAG(0);
+    }
+
+    *topology = topo;
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Topology_neighbors(
+    MIMPI_Topology topology,
+    int *indegree,
+    int *sources,
+    int *outdegree,
+    int *destinations
+) {
+    *indegree = topology->indegree;
+    *outdegree = topology->outdegree;
+    if (sources != NULL) {
+        memcpy(sources, topology->sources, topology->indegree * sizeof(int));
+    }
+    if (destinations != NULL) {
+        memcpy(destinations, topology->destinations, topology->outdegree * sizeof(int));
+    }
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Topology_free(MIMPI_Topology *topology) {
+    MIMPI_Topology topo = *topology;
+    if (topo == MIMPI_TOPOLOGY_NULL) {
+        return MIMPI_SUCCESS;
+    }
+    free(topo->dims);
+    free(topo->periods);
+    free(topo->sources);
+    free(topo->destinations);
+    free(topo->recv_tags);
+    free(topo->send_tags);
+    free(topo);
+    *topology = MIMPI_TOPOLOGY_NULL;
+    return MIMPI_SUCCESS;
+}
+
+// All receives are posted before any send, so that data from all
+// neighbours flow in at once. With block_stride 0 every neighbour
+// gets the same data, otherwise its own block.
+static MIMPI_Retcode MIMPI_neighbor_exchange(
+    MIMPI_Topology topo,
+    void const *send_data,
+    int block_stride,
+    void *recv_data,
+    int count
+) {
+    MIMPI_collectives_flush();
+    const int indegree = topo->indegree;
+    MIMPI_Message *patterns = calloc(indegree + 1, sizeof(MIMPI_Message));
+    MIMPI_Waiter *waiters = calloc(indegree + 1, sizeof(MIMPI_Waiter));
+    bool *filled = calloc(indegree + 1, sizeof(bool));
+    ASSERT_NOT_NULL(patterns);
+    ASSERT_NOT_NULL(waiters);
+    ASSERT_NOT_NULL(filled);
+
+    for (int i = 0; i < indegree; i++) {
+        const int source = topo->sources[i];
+        if (source == MIMPI_PROC_NULL || source == my_rank) {
+            continue;
+        }
+        patterns[i].source = source;
+        patterns[i].tag = topo->recv_tags[i];
+        patterns[i].count = count;
+        waiters[i].pattern = &patterns[i];
+        waiters[i].claim = true;
+        MIMPI_post_waiter(&waiters[i]);
+    }
+
+    for (int j = 0; j < topo->outdegree; j++) {
+        const int destination = topo->destinations[j];
+        char const *block = (char const*)send_data + j * block_stride;
+        if (destination == MIMPI_PROC_NULL) {
+            continue;
+        }
+        if (destination != my_rank) {
+            MIMPI_Send(block, count, destination, topo->send_tags[j]);
+            continue;
         }
+        // to itself, lands in the first free slot expecting such a message
+        for (int i = 0; i < indegree; i++) {
+            if (topo->sources[i] == my_rank && !filled[i]
+                && topo->recv_tags[i] == topo->send_tags[j]) {
+                memcpy((char*)recv_data + i * count, block, count);
+                filled[i] = true;
+                break;
+            }
+        }
+    }
+
+    MIMPI_Retcode res = MIMPI_SUCCESS;
+    for (int i = 0; i < indegree; i++) {
+        if (waiters[i].pattern == NULL) {
+            continue;
+        }
+        MIMPI_Retcode recv_res = MIMPI_wait_waiter(&waiters[i], NULL);
+        if (recv_res == MIMPI_SUCCESS) {
+            MIMPI_consume_message(waiters[i].found, (char*)recv_data + i * count, count);
+        }
+        else if (res == MIMPI_SUCCESS) {
+            res = recv_res;
+        }
+    }
+
+    free(patterns);
+    free(waiters);
+    free(filled);
+    return res;
+}
+
+MIMPI_Retcode MIMPI_Neighbor_allgather(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Topology topology
+) {
+    return MIMPI_neighbor_exchange(topology, send_data, 0, recv_data, count);
+}
+
+MIMPI_Retcode MIMPI_Neighbor_alltoall(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Topology topology
+) {
+    return MIMPI_neighbor_exchange(topology, send_data, count, recv_data, count);
+}
+
+// what a process brings to MIMPI_Comm_split
+typedef struct {
+    int rank; // in the split communicator
+    int color, key;
+    int next_context;
+} MIMPI_Split_record;
+
+static int MIMPI_compare_split_records(void const *a, void const *b) {
+    MIMPI_Split_record const *x = a, *y = b;
+    if (x->key != y->key) {
+        return (x->key < y->key ? -1 : 1);
+    }
+    return (x->rank < y->rank ? -1 : (x->rank > y->rank));
+}
+
+MIMPI_Retcode MIMPI_Comm_split(
+    MIMPI_Comm comm,
+    int color,
+    int key,
+    MIMPI_Comm *newcomm
+) {
+    MIMPI_collectives_flush();
+    comm = MIMPI_comm(comm);
+
+    // records of everyone go up the tree and then the whole table comes back down
+    MIMPI_Tree tree = MIMPI_comm_tree(comm, 0);
+    const int table_size = comm->size * sizeof(MIMPI_Split_record);
+    int len = sizeof(MIMPI_Split_record), capacity = table_size;
+    char *buf = malloc(capacity);
+    ASSERT_NOT_NULL(buf);
+    *(MIMPI_Split_record*)buf = (MIMPI_Split_record) {
+        .rank = comm->rank, .color = color, .key = key, .next_context = next_context
+    };
+
+    MIMPI_Retcode res = MIMPI_SUCCESS;
+    for (int i = 0; i < tree.child_count && res == MIMPI_SUCCESS; i++) {
+        res = MIMPI_recv_appended(tree.context, &buf, &len, &capacity,
+                                  tree.children[i], GROUP_BEGIN);
+    }
+    if (res == MIMPI_SUCCESS && tree.parent != -1) {
+        MIMPI_send_in(tree.context, buf, len, tree.parent, GROUP_BEGIN);
+        res = MIMPI_recv_in(tree.context, buf, table_size, tree.parent, GROUP_END);
+    }
+    if (res != MIMPI_SUCCESS) {
+        free(buf);
+        return res;
+    }
+    for (int i = 0; i < tree.child_count; i++) {
+        MIMPI_send_in(tree.context, buf, table_size, tree.children[i], GROUP_END);
     }
 
+    // a context none of the members has used yet, the same for all new communicators
+    MIMPI_Split_record *records = (MIMPI_Split_record*)buf;
+    int context = next_context;
+    for (int i = 0; i < comm->size; i++) {
+        context = MAX(context, records[i].next_context);
+    }
+    next_context = context + 1;
+
+    if (color < 0) {
+        free(buf);
+        return MIMPI_SUCCESS;
+    }
+
+    int members = 0;
+    for (int i = 0; i < comm->size; i++) {
+        if (records[i].color == color) {
+            records[members++] = records[i];
+        }
+    }
+    qsort(records, members, sizeof(MIMPI_Split_record), MIMPI_compare_split_records);
+
+    MIMPI_Comm new = malloc(sizeof(struct MIMPI_Comm_data));
+    ASSERT_NOT_NULL(new);
+    ASSERT_NOT_NULL(new->ranks = malloc(members * sizeof(int)));
+    new->context = context;
+    new->size = members;
+    for (int i = 0; i < members; i++) {
+        new->ranks[i] = comm->ranks[records[i].rank];
+        if (records[i].rank == comm->rank) {
+            new->rank = i;
+        }
+    }
+    free(buf);
+
+    *newcomm = new;
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Comm_dup(MIMPI_Comm comm, MIMPI_Comm *newcomm) {
+    return MIMPI_Comm_split(comm, 0, MIMPI_comm(comm)->rank, newcomm);
+}
+
+MIMPI_Retcode MIMPI_Comm_free(MIMPI_Comm *comm) {
+    if (*comm != MIMPI_COMM_WORLD) {
+        free((*comm)->ranks);
+        free(*comm);
+        *comm = MIMPI_COMM_WORLD;
+    }
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Comm_rank(MIMPI_Comm comm, int *rank) {
+    *rank = MIMPI_comm(comm)->rank;
+    return MIMPI_SUCCESS;
+}
+
+MIMPI_Retcode MIMPI_Comm_size(MIMPI_Comm comm, int *size) {
+    *size = MIMPI_comm(comm)->size;
     return MIMPI_SUCCESS;
-}
\ No newline at end of file
+}
+
+MIMPI_Retcode MIMPI_Comm_send(
+    void const *data,
+    int count,
+    int destination,
+    int tag,
+    MIMPI_Comm comm
+) {
+    comm = MIMPI_comm(comm);
+    if (comm->rank == destination) 
+        {return MIMPI_ERROR_ATTEMPTED_SELF_OP;}
+    if (destination < 0 || destination >= comm->size) 
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    return MIMPI_send_in(comm->context, data, count, comm->ranks[destination], tag);
+}
+
+MIMPI_Retcode MIMPI_Comm_recv(
+    void *data,
+    int count,
+    int source,
+    int tag,
+    MIMPI_Comm comm
+) {
+    comm = MIMPI_comm(comm);
+    if (comm->rank == source) 
+        {return MIMPI_ERROR_ATTEMPTED_SELF_OP;}
+    if (source < 0 || source >= comm->size) 
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    return MIMPI_recv_in(comm->context, data, count, comm->ranks[source], tag);
+}
+
+MIMPI_Retcode MIMPI_Comm_barrier(MIMPI_Comm comm) {
+    MIMPI_collectives_flush();
+    MIMPI_Tree tree = MIMPI_comm_tree(MIMPI_comm(comm), 0);
+    return MIMPI_tree_bcast(&tree, NULL, 0);
+}
+
+MIMPI_Retcode MIMPI_Comm_bcast(
+    void *data,
+    int count,
+    int root,
+    MIMPI_Comm comm
+) {
+    comm = MIMPI_comm(comm);
+    if (root < 0 || root >= comm->size)
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    MIMPI_collectives_flush();
+    MIMPI_Tree tree = MIMPI_comm_tree(comm, root);
+    return MIMPI_tree_bcast(&tree, data, count);
+}
+
+MIMPI_Retcode MIMPI_Comm_reduce(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Op op,
+    int root,
+    MIMPI_Comm comm
+) {
+    comm = MIMPI_comm(comm);
+    if (root < 0 || root >= comm->size)
+        {return MIMPI_ERROR_NO_SUCH_RANK;}
+
+    MIMPI_collectives_flush();
+    MIMPI_Tree tree = MIMPI_comm_tree(comm, root);
+    return MIMPI_reduce_on_tree(&tree, send_data, recv_data, count, op);
+}
+
+// A packed sparse vector starts with the number of its nonzero entries,
+// followed by their indices in increasing order and then their values.
+// The number is -1 when the vector is dense, then all count bytes follow.
+static char *MIMPI_sparse_pack(int entries, int const *indices, char const *values, int count, int *len) {
+    char *packed;
+    if (entries * SPARSE_ENTRY_SIZE >= count) {
+        *len = sizeof(int) + count;
+        ASSERT_NOT_NULL(packed = malloc(*len));
+        memset(packed + sizeof(int), 0, count);
+        for (int i = 0; i < entries; i++) {
+            packed[sizeof(int) + indices[i]] = values[i];
+        }
+        entries = -1;
+    }
+    else {
+        *len = sizeof(int) + entries * SPARSE_ENTRY_SIZE;
+        ASSERT_NOT_NULL(packed = malloc(*len));
+        memcpy(packed + sizeof(int), indices, entries * sizeof(int));
+        memcpy(packed + sizeof(int) + entries * sizeof(int), values, entries);
+    }
+    memcpy(packed, &entries, sizeof(int));
+    return packed;
+}
+
+static void MIMPI_sparse_unpack(char const *packed, char *data, int count) {
+    int entries;
+    memcpy(&entries, packed, sizeof(int));
+    if (entries == -1) {
+        memcpy(data, packed + sizeof(int), count);
+        return;
+    }
+    int const *indices = (int const*)(packed + sizeof(int));
+    char const *values = packed + sizeof(int) + entries * sizeof(int);
+    memset(data, 0, count);
+    for (int i = 0; i < entries; i++) {
+        data[indices[i]] = values[i];
+    }
+}
+
+static char *MIMPI_sparse_from_dense(char const *data, int count, int *len) {
+    int entries = 0;
+    for (int i = 0; i < count; i++) {
+        entries += (data[i] != 0);
+    }
+    int *indices = malloc(entries * sizeof(int) + 1);
+    char *values = malloc(entries + 1);
+    ASSERT_NOT_NULL(indices);
+    ASSERT_NOT_NULL(values);
+    for (int i = 0, j = 0; i < count; i++) {
+        if (data[i] != 0) {
+            indices[j] = i;
+            values[j++] = data[i];
+        }
+    }
+
+    char *packed = MIMPI_sparse_pack(entries, indices, values, count, len);
+    free(indices);
+    free(values);
+    return packed;
+}
+
+// Reduces two packed vectors into a new one. Entries missing from a sparse
+// vector are zeros, so an entry present only in one of them is reduced with 0.
+static char *MIMPI_sparse_merge(char const *a, char const *b, int count, MIMPI_Op op, int *len) {
+    int a_entries, b_entries;
+    memcpy(&a_entries, a, sizeof(int));
+    memcpy(&b_entries, b, sizeof(int));
+
+    if (a_entries == -1 || b_entries == -1) {
+        char *result = malloc(sizeof(int) + count);
+        char *other = MIMPI_byte_buffer(count);
+        ASSERT_NOT_NULL(result);
+        const int dense = -1;
+        memcpy(result, &dense, sizeof(int));
+        MIMPI_sparse_unpack(a, result + sizeof(int), count);
+        MIMPI_sparse_unpack(b, other, count);
+        reduce_data(result + sizeof(int), other, count, op);
+        free(other);
+        *len = sizeof(int) + count;
+        return result;
+    }
+
+    int const *a_indices = (int const*)(a + sizeof(int));
+    int const *b_indices = (int const*)(b + sizeof(int));
+    char const *a_values = a + sizeof(int) + a_entries * sizeof(int);
+    char const *b_values = b + sizeof(int) + b_entries * sizeof(int);
+    int *indices = malloc((a_entries + b_entries) * sizeof(int) + 1);
+    char *values = malloc(a_entries + b_entries + 1);
+    ASSERT_NOT_NULL(indices);
+    ASSERT_NOT_NULL(values);
+
+    int i = 0, j = 0, entries = 0;
+    while (i < a_entries || j < b_entries) {
+        int index;
+        char value, other = 0;
+        if (j == b_entries || (i < a_entries && a_indices[i] < b_indices[j])) {
+            index = a_indices[i];
+            value = a_values[i++];
+        }
+        else if (i == a_entries || b_indices[j] < a_indices[i]) {
+            index = b_indices[j];
+            value = b_values[j++];
+        }
+        else {
+            index = a_indices[i];
+            value = a_values[i++];
+            other = b_values[j++];
+        }
+        reduce_data(&value, &other, 1, op);
+        if (value != 0) {
+            indices[entries] = index;
+            values[entries++] = value;
+        }
+    }
+
+    char *packed = MIMPI_sparse_pack(entries, indices, values, count, len);
+    free(indices);
+    free(values);
+    return packed;
+}
+
+MIMPI_Retcode MIMPI_Sparse_allreduce(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Op op
+) {
+    MIMPI_collectives_flush();
+    MIMPI_Tree tree = MIMPI_heap_tree(0);
+
+    int len;
+    char *result = MIMPI_sparse_from_dense(send_data, count, &len);
+    char *buf = NULL;
+    int capacity = 0;
+
+    MIMPI_Retcode res = MIMPI_SUCCESS;
+    for (int i = 0; i < tree.child_count && res == MIMPI_SUCCESS; i++) {
+        int buf_len = 0;
+        res = MIMPI_recv_appended(tree.context, &buf, &buf_len, &capacity,
+                                  tree.children[i], GROUP_BEGIN);
+        if (res == MIMPI_SUCCESS) {
+            char *merged = MIMPI_sparse_merge(result, buf, count, op, &len);
+            free(result);
+            result = merged;
+        }
+    }
+    free(buf);
+
+    // the root's result goes back down as it is, dense or not
+    if (res == MIMPI_SUCCESS && tree.parent != -1) {
+        MIMPI_send_in(tree.context, result, len, tree.parent, GROUP_BEGIN);
+        len = capacity = 0;
+        res = MIMPI_recv_appended(tree.context, &result, &len, &capacity,
+                                  tree.parent, GROUP_END);
+    }
+    if (res == MIMPI_SUCCESS) {
+        for (int i = 0; i < tree.child_count; i++) {
+            MIMPI_send_in(tree.context, result, len, tree.children[i], GROUP_END);
+        }
+        MIMPI_sparse_unpack(result, recv_data, count);
+    }
+    free(result);
+    return res;
+}
@@ -2,6 +2,9 @@
 #define MIMPI_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <sys/uio.h>
+#include <time.h>
 
 #define MIMPI_ANY_TAG 0
 
@@ -12,6 +15,10 @@ typedef enum {
     MIMPI_ERROR_NO_SUCH_RANK = 2, /// no process with requested rank exists in the world
     MIMPI_ERROR_REMOTE_FINISHED = 3, /// the remote process involved in communication has finished
     MIMPI_ERROR_DEADLOCK_DETECTED = 4, /// a deadlock has been detected
+    MIMPI_ERROR_TRUNCATED = 5, /// received message didn't fit in the provided buffer
+    MIMPI_ERROR_BUFFER_OVERFLOW = 6, /// buffered send didn't fit in the attached buffer
+    MIMPI_ERROR_TIMEOUT = 7, /// no matching message arrived before the deadline
+    MIMPI_ERROR_INVALID_TOPOLOGY = 8, /// process topology doesn't fit the world or the request
 } MIMPI_Retcode;
 
 /// @brief Reduction operation kind.
@@ -24,6 +31,76 @@ typedef enum {
     MIMPI_PROD,
 } MIMPI_Op;
 
+/// @brief Algorithm used by @ref MIMPI_Barrier().
+///
+/// Chosen with @ref MIMPI_Set_barrier_algorithm() or, before that,
+/// by setting the `MIMPI_BARRIER` environment variable to `tree`
+/// or `dissemination`.
+typedef enum {
+    MIMPI_BARRIER_TREE, /// up a binary tree and back down, the default
+    MIMPI_BARRIER_DISSEMINATION, /// ceil(log2(world_size)) rounds, all processes sending in each
+} MIMPI_Barrier_algorithm;
+
+/// @brief Description of a received or pending message.
+///
+/// Filled by @ref MIMPI_Probe() and similar procedures.
+typedef struct {
+    int source; /// rank of the process who sent the message
+    int tag; /// tag the message was sent with
+    int count; /// number of bytes of data in the message
+} MIMPI_Status;
+
+/// @brief Handle to a message claimed by @ref MIMPI_Mprobe().
+typedef struct MIMPI_Node *MIMPI_Message_handle;
+
+#define MIMPI_MESSAGE_NULL NULL
+
+/// @brief Handle to a persistent communication request.
+///
+/// Created by @ref MIMPI_Send_init() and similar procedures.
+typedef struct MIMPI_Request_data *MIMPI_Request;
+
+#define MIMPI_REQUEST_NULL NULL
+
+/// @brief Handle to a datatype describing layout of data in memory.
+///
+/// Created by @ref MIMPI_Type_vector() and similar procedures.
+typedef struct MIMPI_Datatype_data *MIMPI_Datatype;
+
+/// @brief A single byte, the datatype all others are built from.
+#define MIMPI_BYTE NULL
+
+/// @brief Handle to a process topology describing neighbours of processes.
+///
+/// Created by @ref MIMPI_Cart_create() and @ref MIMPI_Dist_graph_create().
+typedef struct MIMPI_Topology_data *MIMPI_Topology;
+
+#define MIMPI_TOPOLOGY_NULL NULL
+
+/// Rank of a neighbour that doesn't exist, e.g. past the edge of a grid.
+#define MIMPI_PROC_NULL -1
+
+/// @brief Handle to a communicator: a group of processes whose messages
+///        never match messages of other communicators.
+///
+/// Created by @ref MIMPI_Comm_split() and @ref MIMPI_Comm_dup().
+typedef struct MIMPI_Comm_data *MIMPI_Comm;
+
+/// Communicator of all processes, used by procedures without one.
+#define MIMPI_COMM_WORLD NULL
+
+/// @brief Usage of the buffer attached for buffered sends.
+///
+/// Filled by @ref MIMPI_Buffer_stats().
+typedef struct {
+    int size; /// size of the attached buffer
+    int used; /// bytes currently taken by messages not sent yet
+    int peak_used; /// the most bytes taken at once since attaching
+    int pending; /// number of messages not sent yet
+    int overflows; /// number of buffered sends rejected for lack of space
+    int failed; /// number of buffered messages whose destination had finished
+} MIMPI_Buffer_usage;
+
 /// @brief Initialises MIMPI framework in MIMPI programs.
 ///
 /// Opens an _MPI block_, permitting use of other MIMPI procedures.
@@ -76,6 +153,60 @@ MIMPI_Retcode MIMPI_Send(
     int tag
 );
 
+/// @brief Attaches a buffer for buffered sends.
+///
+/// Messages sent with @ref MIMPI_Bsend are copied to @ref buffer and
+/// written out by a background thread. If another buffer is attached,
+/// it's detached first.
+///
+/// @param buffer - memory to be used, owned by MIMPI until detached.
+/// @param size - size of @ref buffer in bytes.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///
+MIMPI_Retcode MIMPI_Buffer_attach(void *buffer, int size);
+
+/// @brief Detaches the buffer used for buffered sends.
+///
+/// Blocks until all buffered messages are written out.
+/// @ref MIMPI_Finalize detaches the buffer if it's still attached.
+///
+/// @param buffer - place where address of the detached buffer is to be put.
+/// @param size - place where its size is to be put.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///
+MIMPI_Retcode MIMPI_Buffer_detach(void **buffer, int *size);
+
+/// @brief Sends data to the specified process without blocking.
+///
+/// Works like @ref MIMPI_Send, but copies @ref data to the attached
+/// buffer and returns immediately. Messages to the same destination,
+/// buffered or not, arrive in the order they were sent.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_ATTEMPTED_SELF_OP` if process attempted to send to itself
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref destination in the world.
+///         - `MIMPI_ERROR_BUFFER_OVERFLOW` if there isn't enough free space
+///           in the attached buffer (or no buffer is attached).
+///
+MIMPI_Retcode MIMPI_Bsend(
+    void const *data,
+    int count,
+    int destination,
+    int tag
+);
+
+/// @brief Reports usage of the buffer attached for buffered sends.
+///
+/// @param usage - place where the usage is to be put.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///
+MIMPI_Retcode MIMPI_Buffer_stats(MIMPI_Buffer_usage *usage);
+
 /// @brief Receives data from the specified process.
 ///
 /// Blocks until @ref count bytes of @ref data tagged with @ref tag arrives
@@ -103,76 +234,1379 @@ MIMPI_Retcode MIMPI_Recv(
     int tag
 );
 
-/// @brief Synchronises all processes.
+/// @brief Receives data from the specified process, giving up at a deadline.
 ///
-/// Blocks execution of the calling process until all processes execute
-/// this function. In particular, every process executes all instructions
-/// preceding the call before any process executes any instruction
-/// following the call. 
+/// Works like @ref MIMPI_Recv, but stops waiting when @ref deadline passes.
+/// A message that arrives later is left for following receives.
+///
+/// @param deadline - absolute time, measured by `CLOCK_MONOTONIC`
+///                   (see `clock_gettime`).
+/// @return MIMPI return code: same as @ref MIMPI_Recv, and additionally
+///         - `MIMPI_ERROR_TIMEOUT` if no matching message arrived
+///           before @ref deadline.
+///
+MIMPI_Retcode MIMPI_Recv_deadline(
+    void *data,
+    int count,
+    int source,
+    int tag,
+    const struct timespec *deadline
+);
+
+/// @brief Receives data from the specified process, waiting at most
+///        @ref timeout_ms milliseconds.
+///
+/// Works like @ref MIMPI_Recv_deadline with the deadline
+/// @ref timeout_ms milliseconds from now.
+///
+/// @return MIMPI return code: same as @ref MIMPI_Recv_deadline.
+///
+MIMPI_Retcode MIMPI_Recv_timeout(
+    void *data,
+    int count,
+    int source,
+    int tag,
+    int timeout_ms
+);
+
+/// @brief Receives data of unknown size from the specified process.
+///
+/// Works like @ref MIMPI_Recv, but matches messages only by @ref source
+/// and @ref tag. Blocks until the first such message arrives, then puts
+/// its data (at most @ref max_count bytes) in @ref data.
 ///
+/// @param data - place where received data is to be put.
+/// @param max_count - number of bytes available at @ref data.
+/// @param source - rank of the process for data from we are waiting. 
+/// @param tag - a discriminant of the data, which can be used
+///              to distinguish between messages.
+/// @param status - if not NULL, place where source, tag and actual size
+///                 of the received message are to be put.
 /// @return MIMPI return code:
 ///         - `MIMPI_SUCCESS` if operation ended successfully.
-///         - `MIMPI_ERROR_REMOTE_FINISHED` if any process in the world
-///            has already escaped _MPI block_.
-///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
-///           and therefore this call would else never return.
+///         - `MIMPI_ERROR_ATTEMPTED_SELF_OP` if process attempted to receive from itself
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref source in the world.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if the process with rank
+///         - @ref source has already escaped _MPI block_.
+///         - `MIMPI_ERROR_TRUNCATED` if the message was longer than
+///           @ref max_count bytes. The message is received anyway, only
+///           its first @ref max_count bytes are put in @ref data.
 ///
-MIMPI_Retcode MIMPI_Barrier();
+MIMPI_Retcode MIMPI_Recv_status(
+    void *data,
+    int max_count,
+    int source,
+    int tag,
+    MIMPI_Status *status
+);
 
-/// @brief Broadcasts data to all processes.
+/// @brief Sends data gathered from multiple buffers.
 ///
-/// Makes @ref count bytes of data at address @ref data in process @ref root
-/// available among all processes at address @ref data.
-/// Additionally, is a synchronisation point similarly to @ref MIMPI_Barrier.
+/// Works like @ref MIMPI_Send of the concatenation of the @ref iovcnt
+/// buffers described by @ref iov, but without copying them together first.
+/// The message can be received by any receive of matching size.
 ///
-/// @param data - for @ref root, data to be broadcast; for other processes,
-///               place where data are to be put.
-/// @param count - number of bytes of data to be broadcast.
-/// @param root - rank of the process whose data are to be broadcast.
+/// @return MIMPI return code: same as @ref MIMPI_Send.
+///
+MIMPI_Retcode MIMPI_Sendv(
+    const struct iovec *iov,
+    int iovcnt,
+    int destination,
+    int tag
+);
+
+/// @brief Receives data scattering it to multiple buffers.
+///
+/// Works like @ref MIMPI_Recv of as many bytes as the @ref iovcnt buffers
+/// described by @ref iov hold together, filling them one after another.
+///
+/// @return MIMPI return code: same as @ref MIMPI_Recv.
+///
+MIMPI_Retcode MIMPI_Recvv(
+    const struct iovec *iov,
+    int iovcnt,
+    int source,
+    int tag
+);
+
+/// @brief Creates a datatype of equally spaced blocks.
+///
+/// The new datatype consists of @ref count blocks of @ref blocklength
+/// elements of @ref oldtype, starting @ref stride elements apart.
 ///
+/// @param newtype - place where the new datatype is to be put.
 /// @return MIMPI return code:
 ///         - `MIMPI_SUCCESS` if operation ended successfully.
-///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
-///           @ref root in the world.
-///         - `MIMPI_ERROR_REMOTE_FINISHED` if any process in the world
-///            has already escaped _MPI block_.
-///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
-///           and therefore this call would else never return.
 ///
-MIMPI_Retcode MIMPI_Bcast(
+MIMPI_Retcode MIMPI_Type_vector(
+    int count,
+    int blocklength,
+    int stride,
+    MIMPI_Datatype oldtype,
+    MIMPI_Datatype *newtype
+);
+
+/// @brief Creates a datatype of arbitrarily placed blocks.
+///
+/// The new datatype consists of @ref count blocks, i-th of them being
+/// @ref blocklengths[i] elements of @ref oldtype starting
+/// @ref displacements[i] elements from the beginning.
+///
+/// @param newtype - place where the new datatype is to be put.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///
+MIMPI_Retcode MIMPI_Type_indexed(
+    int count,
+    const int blocklengths[],
+    const int displacements[],
+    MIMPI_Datatype oldtype,
+    MIMPI_Datatype *newtype
+);
+
+/// @brief Creates a datatype of blocks of different datatypes.
+///
+/// The new datatype consists of @ref count blocks, i-th of them being
+/// @ref blocklengths[i] elements of @ref types[i] starting
+/// @ref displacements[i] bytes from the beginning.
+///
+/// @param newtype - place where the new datatype is to be put.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///
+MIMPI_Retcode MIMPI_Type_create_struct(
+    int count,
+    const int blocklengths[],
+    const int displacements[],
+    const MIMPI_Datatype types[],
+    MIMPI_Datatype *newtype
+);
+
+/// @brief Returns the number of bytes of data in one element of @ref type.
+MIMPI_Retcode MIMPI_Type_size(MIMPI_Datatype type, int *size);
+
+/// @brief Frees a datatype and sets it to `MIMPI_BYTE`.
+///
+/// Datatypes built from it are not affected.
+MIMPI_Retcode MIMPI_Type_free(MIMPI_Datatype *type);
+
+/// @brief Packs @ref count elements of @ref type at @ref data
+///        into contiguous @ref packed.
+MIMPI_Retcode MIMPI_Pack(
+    void const *data,
+    int count,
+    MIMPI_Datatype type,
+    void *packed
+);
+
+/// @brief Unpacks contiguous @ref packed into @ref count elements
+///        of @ref type at @ref data.
+MIMPI_Retcode MIMPI_Unpack(
+    void const *packed,
     void *data,
     int count,
-    int root
+    MIMPI_Datatype type
 );
 
-/// @brief Reduces data from all processes to one.
+/// @brief Sends @ref count elements of @ref type at @ref data.
 ///
-/// Performs reduction of kind @ref op over @ref count bytes of data
-/// stored at address @ref send_data in every process. The reduction's result
-/// is put at @ref recv_data *ONLY* in the process with rank @ref root.
-/// Additionally, is a synchronisation point similarly to @ref MIMPI_Barrier.
+/// Works like @ref MIMPI_Send of the packed elements, gathering them
+/// straight into the channel writes. The message can be received by any
+/// receive of matching size.
 ///
-/// @param send_data - data to be reduced.
-/// @param recv_data - place where reduction's result is to be put.
-/// @param count - number of bytes of data to be reduced.
-/// @param op - a particular operation to be performed for reduction.
-/// @param root - rank of the process who is to hold the result of reduction.
+/// @return MIMPI return code: same as @ref MIMPI_Send.
+///
+MIMPI_Retcode MIMPI_Send_typed(
+    void const *data,
+    int count,
+    MIMPI_Datatype type,
+    int destination,
+    int tag
+);
+
+/// @brief Receives @ref count elements of @ref type to @ref data.
+///
+/// Works like @ref MIMPI_Recv of the packed elements.
+///
+/// @return MIMPI return code: same as @ref MIMPI_Recv.
+///
+MIMPI_Retcode MIMPI_Recv_typed(
+    void *data,
+    int count,
+    MIMPI_Datatype type,
+    int source,
+    int tag
+);
+
+/// @brief Sends data to one process and receives data from another.
 ///
+/// Has the same effect as @ref MIMPI_Send followed by @ref MIMPI_Recv,
+/// but the receive is posted before sending, so the incoming message
+/// is transferred while the outgoing one is being sent.
+///
+/// @param send_data - data to be sent.
+/// @param send_count - number of bytes of data to be sent.
+/// @param destination - rank of the process who is to receive the data. 
+/// @param send_tag - tag of the sent message.
+/// @param recv_data - place where received data is to be put.
+/// @param recv_count - number of bytes of data to be received.
+/// @param source - rank of the process for data from we are waiting. 
+/// @param recv_tag - tag of the message to be received.
 /// @return MIMPI return code:
 ///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_ATTEMPTED_SELF_OP` if @ref destination or @ref source
+///           is the calling process.
 ///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
-///           @ref root in the world.
-///         - `MIMPI_ERROR_REMOTE_FINISHED` if any process in the world
-///            has already escaped _MPI block_.
-///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
-///           and therefore this call would else never return.
+///           @ref destination or @ref source in the world.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if the process with rank
+///           @ref destination or @ref source has already escaped _MPI block_.
 ///
-MIMPI_Retcode MIMPI_Reduce(
+MIMPI_Retcode MIMPI_Sendrecv(
     void const *send_data,
+    int send_count,
+    int destination,
+    int send_tag,
     void *recv_data,
+    int recv_count,
+    int source,
+    int recv_tag
+);
+
+/// @brief Sends data to one process and replaces it with data from another.
+///
+/// Works like @ref MIMPI_Sendrecv, using the same buffer @ref data
+/// of @ref count bytes for both the sent and the received message.
+///
+/// @return MIMPI return code: same as @ref MIMPI_Sendrecv.
+///
+MIMPI_Retcode MIMPI_Sendrecv_replace(
+    void *data,
     int count,
-    MIMPI_Op op,
-    int root
+    int destination,
+    int send_tag,
+    int source,
+    int recv_tag
+);
+
+/// @brief Waits for a message without receiving it.
+///
+/// Blocks until a message tagged with @ref tag from the process with rank
+/// @ref source is pending, regardless of its size. The message stays
+/// in the queue and can be received later with @ref MIMPI_Recv.
+///
+/// @param source - rank of the process for data from we are waiting. 
+/// @param tag - a discriminant of the data, which can be used
+///              to distinguish between messages.
+/// @param status - if not NULL, place where source, tag and size
+///                 of the pending message are to be put.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_ATTEMPTED_SELF_OP` if process attempted to probe itself
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref source in the world.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if the process with rank
+///         - @ref source has already escaped _MPI block_.
+///
+MIMPI_Retcode MIMPI_Probe(
+    int source,
+    int tag,
+    MIMPI_Status *status
+);
+
+/// @brief Checks whether a message is pending without receiving it.
+///
+/// Works like @ref MIMPI_Probe, but never blocks.
+///
+/// @param source - rank of the process whose messages are checked.
+/// @param tag - a discriminant of the data, which can be used
+///              to distinguish between messages.
+/// @param flag - set to whether a matching message is pending.
+/// @param status - if not NULL and a message is pending, place where
+///                 its source, tag and size are to be put.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_ATTEMPTED_SELF_OP` if process attempted to probe itself
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref source in the world.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if no message is pending and
+///           the process with rank @ref source has already escaped _MPI block_.
+///
+MIMPI_Retcode MIMPI_Iprobe(
+    int source,
+    int tag,
+    bool *flag,
+    MIMPI_Status *status
+);
+
+/// @brief Waits for a message and claims it for a later @ref MIMPI_Mrecv.
+///
+/// Works like @ref MIMPI_Probe, but the found message is taken out of
+/// matching, so no other receive (e.g. in another thread) can get it.
+///
+/// @param source - rank of the process for data from we are waiting. 
+/// @param tag - a discriminant of the data, which can be used
+///              to distinguish between messages.
+/// @param message - place where handle to the claimed message is to be put.
+/// @param status - if not NULL, place where source, tag and size
+///                 of the claimed message are to be put.
+/// @return MIMPI return code: same as @ref MIMPI_Probe.
+///
+MIMPI_Retcode MIMPI_Mprobe(
+    int source,
+    int tag,
+    MIMPI_Message_handle *message,
+    MIMPI_Status *status
+);
+
+/// @brief Receives a message claimed by @ref MIMPI_Mprobe.
+///
+/// Blocks until the whole message is buffered, puts it in @ref data
+/// and sets @ref message to `MIMPI_MESSAGE_NULL`.
+///
+/// @param data - place where received data is to be put, it has to fit
+///               as many bytes as reported by @ref MIMPI_Mprobe.
+/// @param message - handle to the claimed message.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///
+MIMPI_Retcode MIMPI_Mrecv(
+    void *data,
+    MIMPI_Message_handle *message
+);
+
+/// @brief Creates a persistent request for sending data.
+///
+/// Validates the arguments and prepares a send of @ref count bytes of
+/// @ref data to the process with rank @ref destination tagged with
+/// @ref tag, which is then performed by every @ref MIMPI_Start on
+/// the request. The data is read at the time of each @ref MIMPI_Start.
+///
+/// @param request - place where handle to the new request is to be put.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_ATTEMPTED_SELF_OP` if process attempted to send to itself
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref destination in the world.
+///
+MIMPI_Retcode MIMPI_Send_init(
+    void const *data,
+    int count,
+    int destination,
+    int tag,
+    MIMPI_Request *request
+);
+
+/// @brief Creates a persistent request for receiving data.
+///
+/// Validates the arguments and prepares a receive of @ref count bytes
+/// tagged with @ref tag from the process with rank @ref source into
+/// @ref data. Every @ref MIMPI_Start posts the receive, which is
+/// completed by @ref MIMPI_Wait.
+///
+/// @param request - place where handle to the new request is to be put.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_ATTEMPTED_SELF_OP` if process attempted to receive from itself
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref source in the world.
+///
+MIMPI_Retcode MIMPI_Recv_init(
+    void *data,
+    int count,
+    int source,
+    int tag,
+    MIMPI_Request *request
+);
+
+/// @brief Starts a persistent request.
+///
+/// A started request has to be completed with @ref MIMPI_Wait
+/// before it's started again.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///
+MIMPI_Retcode MIMPI_Start(MIMPI_Request *request);
+
+/// @brief Starts @ref count persistent requests.
+///
+/// All receives are posted before any send is started.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///
+MIMPI_Retcode MIMPI_Startall(int count, MIMPI_Request requests[]);
+
+/// @brief Waits until a started request completes.
+///
+/// Does nothing for `MIMPI_REQUEST_NULL` or a request not started.
+/// A request of a nonblocking collective (see @ref MIMPI_Ibarrier) is freed
+/// and set to `MIMPI_REQUEST_NULL`.
+///
+/// @return MIMPI return code of the completed operation:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if the other process
+///            has already escaped _MPI block_.
+///
+MIMPI_Retcode MIMPI_Wait(MIMPI_Request *request);
+
+/// @brief Checks whether a started request has completed.
+///
+/// Never blocks. If the request has completed, sets @ref flag to true
+/// and completes it as @ref MIMPI_Wait would.
+///
+/// @param flag - place where whether the request has completed is to be put.
+/// @return MIMPI return code: same as @ref MIMPI_Wait if the request has
+///         completed, `MIMPI_SUCCESS` otherwise.
+///
+MIMPI_Retcode MIMPI_Test(MIMPI_Request *request, bool *flag);
+
+/// @brief Waits until @ref count started requests complete.
+///
+/// @return MIMPI return code: `MIMPI_SUCCESS` or the first error returned
+///         by @ref MIMPI_Wait for any of the requests.
+///
+MIMPI_Retcode MIMPI_Waitall(int count, MIMPI_Request requests[]);
+
+/// @brief Frees a request and sets it to `MIMPI_REQUEST_NULL`.
+///
+/// A started receive which hasn't been waited for is cancelled.
+/// A nonblocking collective in progress is waited for.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///
+MIMPI_Retcode MIMPI_Request_free(MIMPI_Request *request);
+
+/// @brief Creates a partitioned send request.
+///
+/// @ref data consists of @ref partitions partitions of @ref count bytes,
+/// each sent to the process with rank @ref destination as soon as it's
+/// marked ready with @ref MIMPI_Pready, e.g. by the thread that has
+/// filled it. Every @ref MIMPI_Start begins a new round, in which each
+/// partition has to be marked ready once. @ref MIMPI_Wait returns when
+/// all of them have been sent. Partitioned messages can be received only
+/// by a matching request created with @ref MIMPI_Precv_init.
+///
+/// @param request - place where handle to the new request is to be put.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_ATTEMPTED_SELF_OP` if process attempted to send to itself
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref destination in the world.
+///
+MIMPI_Retcode MIMPI_Psend_init(
+    void const *data,
+    int partitions,
+    int count,
+    int destination,
+    int tag,
+    MIMPI_Request *request
+);
+
+/// @brief Creates a partitioned receive request.
+///
+/// Receives @ref partitions partitions of @ref count bytes sent by
+/// a partitioned send request of the process with rank @ref source to
+/// @ref data. Partitions which have arrived can be used after
+/// @ref MIMPI_Parrived reports them, all are there after @ref MIMPI_Wait.
+///
+/// @param request - place where handle to the new request is to be put.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_ATTEMPTED_SELF_OP` if process attempted to receive from itself
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref source in the world.
+///
+MIMPI_Retcode MIMPI_Precv_init(
+    void *data,
+    int partitions,
+    int count,
+    int source,
+    int tag,
+    MIMPI_Request *request
+);
+
+/// @brief Marks a partition of a started partitioned send as ready.
+///
+/// Sends the partition right away. May be called concurrently from
+/// multiple threads for different partitions.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if the destination process
+///            has already escaped _MPI block_.
+///
+MIMPI_Retcode MIMPI_Pready(int partition, MIMPI_Request request);
+
+/// @brief Checks whether a partition of a started partitioned receive
+///        has arrived, without blocking.
+///
+/// @param flag - set to whether the partition is already in place.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if the partition hasn't arrived
+///            and the source process has already escaped _MPI block_.
+///
+MIMPI_Retcode MIMPI_Parrived(MIMPI_Request request, int partition, bool *flag);
+
+/// @brief Synchronises all processes.
+///
+/// Blocks execution of the calling process until all processes execute
+/// this function. In particular, every process executes all instructions
+/// preceding the call before any process executes any instruction
+/// following the call. 
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if any process in the world
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Barrier();
+
+/// @brief Chooses the algorithm of @ref MIMPI_Barrier().
+///
+/// The tree barrier sends `2 * (world_size - 1)` messages, but each process
+/// waits for about `2 * log2(world_size)` of them one after another.
+/// The dissemination barrier sends `world_size` messages in each of
+/// `ceil(log2(world_size))` rounds, so it finishes about twice as fast
+/// when sending takes long.
+/// All processes have to use the same algorithm in each barrier.
+///
+/// @param algorithm - algorithm to be used by following barriers.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///
+MIMPI_Retcode MIMPI_Set_barrier_algorithm(MIMPI_Barrier_algorithm algorithm);
+
+/// @brief Broadcasts data to all processes.
+///
+/// Makes @ref count bytes of data at address @ref data in process @ref root
+/// available among all processes at address @ref data.
+/// Large data go down the tree in segments, each passed on as soon as
+/// it arrives, so the time grows with the data size only once and not
+/// once per tree level. Segment size depends on the data size, unless
+/// fixed by the `MIMPI_BCAST_SEGMENT` environment variable (in bytes).
+/// From 1 MiB on the root instead scatters data among all processes,
+/// which then gather them around a ring, so that each process sends
+/// only about twice the data's size.
+/// Additionally, is a synchronisation point similarly to @ref MIMPI_Barrier.
+///
+/// @param data - for @ref root, data to be broadcast; for other processes,
+///               place where data are to be put.
+/// @param count - number of bytes of data to be broadcast.
+/// @param root - rank of the process whose data are to be broadcast.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref root in the world.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if any process in the world
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Bcast(
+    void *data,
+    int count,
+    int root
+);
+
+/// @brief Reduces data from all processes to one.
+///
+/// Performs reduction of kind @ref op over @ref count bytes of data
+/// stored at address @ref send_data in every process. The reduction's result
+/// is put at @ref recv_data *ONLY* in the process with rank @ref root.
+/// Large data go up the tree in segments, each reduced and passed on
+/// while the next one is still arriving. Segment size depends on the data
+/// size, unless fixed by the `MIMPI_REDUCE_SEGMENT` environment variable
+/// (in bytes).
+/// If the `MIMPI_REDUCE_RABENSEIFNER` environment variable is set, data of
+/// at least that many bytes are instead reduced in blocks, each by
+/// a different process (recursive halving), and the reduced blocks are
+/// gathered in the root, so that each process reduces only about
+/// 1/world_size of them (plus the whole data once for some processes,
+/// if world_size isn't a power of two).
+/// Additionally, is a synchronisation point similarly to @ref MIMPI_Barrier.
+///
+/// @param send_data - data to be reduced.
+/// @param recv_data - place where reduction's result is to be put.
+/// @param count - number of bytes of data to be reduced.
+/// @param op - a particular operation to be performed for reduction.
+/// @param root - rank of the process who is to hold the result of reduction.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref root in the world.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if any process in the world
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Reduce(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Op op,
+    int root
+);
+
+/// @brief Reduces data from all processes and distributes the result to all.
+///
+/// Performs reduction of kind @ref op over @ref count bytes of data
+/// stored at address @ref send_data in every process. The reduction's result
+/// is put at @ref recv_data in *EVERY* process.
+/// Works like @ref MIMPI_Reduce followed by @ref MIMPI_Bcast, but faster:
+/// small data go up and back down the tree once, large data are reduced
+/// in blocks around a ring of processes, so that each process sends
+/// only about twice the data's size.
+/// Additionally, is a synchronisation point similarly to @ref MIMPI_Barrier.
+///
+/// @param send_data - data to be reduced.
+/// @param recv_data - place where reduction's result is to be put;
+///                    may be the same as @ref send_data.
+/// @param count - number of bytes of data to be reduced.
+/// @param op - a particular operation to be performed for reduction.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if any process in the world
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Allreduce(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Op op
+);
+
+/// @brief Reduces mostly-zero data from all processes and shares the result.
+///
+/// Gives the same result as @ref MIMPI_Allreduce, but only nonzero bytes
+/// travel, as index/value pairs merged up and back down the tree.
+/// Once the pairs would take as much space as the data themselves,
+/// the data are sent whole. Much faster than @ref MIMPI_Allreduce
+/// when almost all bytes are zeros in every process.
+/// Additionally, is a synchronisation point similarly to @ref MIMPI_Barrier.
+///
+/// @param send_data - data to be reduced.
+/// @param recv_data - place where reduction's result is to be put;
+///                    may be the same as @ref send_data.
+/// @param count - number of bytes of data to be reduced.
+/// @param op - a particular operation to be performed for reduction.
+///
+/// @return MIMPI return code: same as @ref MIMPI_Allreduce.
+///
+MIMPI_Retcode MIMPI_Sparse_allreduce(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Op op
+);
+
+/// @brief Gathers data from all processes in one.
+///
+/// Collects @ref count bytes of data stored at address @ref send_data
+/// in every process. Data from process `i` are put at
+/// `recv_data + i * count` *ONLY* in the process with rank @ref root.
+/// Data travel up a binomial tree, so the root receives only
+/// `ceil(log2(world_size))` messages.
+/// Additionally, is a synchronisation point similarly to @ref MIMPI_Barrier.
+///
+/// @param send_data - data to be gathered.
+/// @param recv_data - place where gathered data are to be put,
+///                    `world_size * count` bytes; used only by @ref root.
+/// @param count - number of bytes of data sent by every process.
+/// @param root - rank of the process who is to hold the gathered data.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref root in the world.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if any process in the world
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Gather(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    int root
+);
+
+/// @brief Gathers data of varying sizes from all processes in one.
+///
+/// Works like @ref MIMPI_Gather, but every process sends its own number
+/// of bytes. Data from process `i` are put at `recv_data + displs[i]`
+/// in the process with rank @ref root.
+///
+/// @param send_data - data to be gathered.
+/// @param send_count - number of bytes of data sent by this process.
+/// @param recv_data - place where gathered data are to be put;
+///                    used only by @ref root.
+/// @param recv_counts - for every process, the number of bytes it sends;
+///                      used only by @ref root.
+/// @param displs - for every process, offset in @ref recv_data where
+///                 its data are to be put; used only by @ref root.
+/// @param root - rank of the process who is to hold the gathered data.
+///
+/// @return MIMPI return code: same as @ref MIMPI_Gather.
+///
+MIMPI_Retcode MIMPI_Gatherv(
+    void const *send_data,
+    int send_count,
+    void *recv_data,
+    int const *recv_counts,
+    int const *displs,
+    int root
+);
+
+/// @brief Gathers data from all processes in all of them.
+///
+/// Works like @ref MIMPI_Gather, but the gathered data are put at
+/// @ref recv_data in *EVERY* process. Small data are gathered with Bruck's
+/// algorithm in `ceil(log2(world_size))` rounds, large data are passed
+/// around a ring of processes.
+/// Additionally, is a synchronisation point similarly to @ref MIMPI_Barrier.
+///
+/// @param send_data - data to be gathered.
+/// @param recv_data - place where gathered data are to be put,
+///                    `world_size * count` bytes.
+/// @param count - number of bytes of data sent by every process.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if any process in the world
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Allgather(
+    void const *send_data,
+    void *recv_data,
+    int count
+);
+
+/// @brief Distributes parts of data from one process to all.
+///
+/// Sends @ref count bytes of data stored at `send_data + i * count`
+/// in the process with rank @ref root to process `i`, where they are put
+/// at @ref recv_data. Data travel down a binomial tree, every process
+/// forwarding only the parts meant for its subtree, so the root sends
+/// only `ceil(log2(world_size))` messages.
+/// Additionally, is a synchronisation point similarly to @ref MIMPI_Barrier.
+///
+/// @param send_data - data to be distributed, `world_size * count` bytes;
+///                    used only by @ref root.
+/// @param recv_data - place where this process's part is to be put.
+/// @param count - number of bytes of data received by every process.
+/// @param root - rank of the process whose data are to be distributed.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref root in the world.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if any process in the world
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Scatter(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    int root
+);
+
+/// @brief Distributes parts of data of varying sizes from one process to all.
+///
+/// Works like @ref MIMPI_Scatter, but process `i` gets its own number
+/// of bytes: `send_counts[i]` bytes stored at `send_data + displs[i]`.
+///
+/// @param send_data - data to be distributed; used only by @ref root.
+/// @param send_counts - for every process, the number of bytes it gets;
+///                      used only by @ref root.
+/// @param displs - for every process, offset in @ref send_data of its part;
+///                 used only by @ref root.
+/// @param recv_data - place where this process's part is to be put.
+/// @param recv_count - at most this many bytes are put at @ref recv_data.
+/// @param root - rank of the process whose data are to be distributed.
+///
+/// @return MIMPI return code: same as @ref MIMPI_Scatter, and additionally
+///         - `MIMPI_ERROR_TRUNCATED` if this process's part was longer
+///           than @ref recv_count; only its beginning was put at
+///           @ref recv_data.
+///
+MIMPI_Retcode MIMPI_Scatterv(
+    void const *send_data,
+    int const *send_counts,
+    int const *displs,
+    void *recv_data,
+    int recv_count,
+    int root
+);
+
+/// @brief Exchanges parts of data between all pairs of processes.
+///
+/// Sends @ref count bytes of data stored at `send_data + i * count`
+/// to process `i`. Data from process `i` are put at `recv_data + i * count`.
+/// Blocks shorter than a threshold are exchanged with Bruck's algorithm
+/// in `ceil(log2(world_size))` steps, longer ones pairwise in
+/// `world_size - 1` steps, in each of which every process sends
+/// to exactly one other and receives from exactly one other.
+/// Additionally, is a synchronisation point similarly to @ref MIMPI_Barrier.
+///
+/// @param send_data - data to be sent, `world_size * count` bytes.
+/// @param recv_data - place where received data are to be put,
+///                    `world_size * count` bytes.
+/// @param count - number of bytes of data sent to every process.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if any process in the world
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Alltoall(
+    void const *send_data,
+    void *recv_data,
+    int count
+);
+
+/// @brief Exchanges parts of data of varying sizes between all pairs
+///        of processes.
+///
+/// Works like @ref MIMPI_Alltoall, but sends `send_counts[i]` bytes
+/// stored at `send_data + send_displs[i]` to process `i` and puts
+/// `recv_counts[i]` bytes from process `i` at `recv_data + recv_displs[i]`.
+/// Always exchanges data pairwise.
+/// `send_counts[j]` in process `i` must equal `recv_counts[i]` in process `j`.
+///
+/// @return MIMPI return code: same as @ref MIMPI_Alltoall.
+///
+MIMPI_Retcode MIMPI_Alltoallv(
+    void const *send_data,
+    int const *send_counts,
+    int const *send_displs,
+    void *recv_data,
+    int const *recv_counts,
+    int const *recv_displs
+);
+
+/// @brief Reports how long steps of the last all-to-all exchange took.
+///
+/// Meant for tuning: tells how the time of the last @ref MIMPI_Alltoall
+/// or @ref MIMPI_Alltoallv called by this process was spread over
+/// its steps (each of them a send and a receive).
+///
+/// @param step_times - place where durations of steps, in seconds,
+///                     are to be put.
+/// @param max_steps - at most this many durations are put at @ref step_times.
+/// @param steps - place where the number of steps is to be put.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` always.
+///
+MIMPI_Retcode MIMPI_Alltoall_timing(double *step_times, int max_steps, int *steps);
+
+/// @brief Computes prefix reductions over processes.
+///
+/// Performs reduction of kind @ref op over @ref count bytes of data
+/// stored at address @ref send_data in processes with ranks
+/// `0, 1, ..., my_rank` and puts the result at @ref recv_data.
+/// Takes `ceil(log2(world_size))` rounds of recursive doubling.
+/// Unlike the other collectives it isn't a synchronisation point:
+/// a process waits only for processes with lower ranks.
+///
+/// @param send_data - data to be reduced.
+/// @param recv_data - place where reduction's result is to be put;
+///                    may be the same as @ref send_data.
+/// @param count - number of bytes of data to be reduced.
+/// @param op - a particular operation to be performed for reduction.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if any process with a lower rank
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Scan(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Op op
+);
+
+/// @brief Computes exclusive prefix reductions over processes.
+///
+/// Works like @ref MIMPI_Scan, but the reduction is over processes with ranks
+/// `0, 1, ..., my_rank - 1`. In process 0, @ref recv_data is left untouched.
+///
+/// @param send_data - data to be reduced.
+/// @param recv_data - place where reduction's result is to be put;
+///                    may be the same as @ref send_data.
+///
+/// @return MIMPI return code: same as @ref MIMPI_Scan.
+///
+MIMPI_Retcode MIMPI_Exscan(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Op op
+);
+
+/// @brief Reduces data from all processes and distributes parts of the result.
+///
+/// Performs reduction of kind @ref op over data stored at address
+/// @ref send_data in every process, made of `world_size` consecutive parts:
+/// `recv_counts[0]` bytes, `recv_counts[1]` bytes and so on.
+/// Part `i` of the result is put at @ref recv_data in process `i`.
+/// Works like @ref MIMPI_Reduce followed by @ref MIMPI_Scatterv, but
+/// without the root: for a power of two processes parts are reduced with
+/// recursive halving in `log2(world_size)` rounds, otherwise around a ring.
+/// Either way each process sends less than the data's size.
+/// Additionally, is a synchronisation point similarly to @ref MIMPI_Barrier.
+///
+/// @param send_data - data to be reduced, sum of @ref recv_counts bytes.
+/// @param recv_data - place where this process's part of reduction's result
+///                    is to be put.
+/// @param recv_counts - for every process, the number of bytes of its part.
+/// @param op - a particular operation to be performed for reduction.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if any process in the world
+///            has already escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Reduce_scatter(
+    void const *send_data,
+    void *recv_data,
+    int const *recv_counts,
+    MIMPI_Op op
+);
+
+/// @brief Reduces data from all processes and distributes equal parts
+///        of the result.
+///
+/// Works like @ref MIMPI_Reduce_scatter with every part @ref count bytes long.
+///
+/// @param send_data - data to be reduced, `world_size * count` bytes.
+/// @param count - number of bytes of every process's part.
+///
+/// @return MIMPI return code: same as @ref MIMPI_Reduce_scatter.
+///
+MIMPI_Retcode MIMPI_Reduce_scatter_block(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Op op
+);
+
+/// @brief Starts a barrier without waiting for it.
+///
+/// Works like @ref MIMPI_Barrier, but returns at once. The barrier is
+/// performed in the background and completed with @ref MIMPI_Wait or
+/// @ref MIMPI_Test, which free the request.
+/// The request has to be completed before @ref MIMPI_Finalize: it still
+/// lets started collectives finish, but doesn't free their requests.
+/// Collectives, blocking or not, are performed in the order they
+/// were called: a blocking one first waits for all started before it.
+///
+/// @param request - place where handle to the new request is to be put.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation started successfully.
+///         Errors of the barrier itself are returned by @ref MIMPI_Wait.
+///
+MIMPI_Retcode MIMPI_Ibarrier(MIMPI_Request *request);
+
+/// @brief Starts a broadcast without waiting for it.
+///
+/// Works like @ref MIMPI_Bcast, but returns at once, see @ref MIMPI_Ibarrier.
+/// @ref data must not be touched until the request completes.
+///
+/// @param request - place where handle to the new request is to be put.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation started successfully.
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref root in the world.
+///         Errors of the broadcast itself are returned by @ref MIMPI_Wait.
+///
+MIMPI_Retcode MIMPI_Ibcast(
+    void *data,
+    int count,
+    int root,
+    MIMPI_Request *request
+);
+
+/// @brief Starts a reduction without waiting for it.
+///
+/// Works like @ref MIMPI_Reduce, but returns at once, see @ref MIMPI_Ibarrier.
+/// @ref send_data and @ref recv_data must not be touched until
+/// the request completes.
+///
+/// @param request - place where handle to the new request is to be put.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation started successfully.
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref root in the world.
+///         Errors of the reduction itself are returned by @ref MIMPI_Wait.
+///
+MIMPI_Retcode MIMPI_Ireduce(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Op op,
+    int root,
+    MIMPI_Request *request
+);
+
+/// @brief Creates a persistent request for broadcasting data.
+///
+/// Prepares a broadcast like @ref MIMPI_Bcast, computing the process's
+/// neighbours in the tree once. Data big enough for @ref MIMPI_Bcast
+/// to scatter them are broadcast the same way. Every @ref MIMPI_Start performs it
+/// in the background, like @ref MIMPI_Ibcast, and @ref MIMPI_Wait completes
+/// it without freeing the request. All processes have to start their
+/// collective requests in the same order.
+///
+/// @param request - place where handle to the new request is to be put.
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref root in the world.
+///
+MIMPI_Retcode MIMPI_Bcast_init(
+    void *data,
+    int count,
+    int root,
+    MIMPI_Request *request
+);
+
+/// @brief Creates a persistent request for reducing data.
+///
+/// Prepares a reduction like @ref MIMPI_Reduce, computing the process's
+/// neighbours in the tree and allocating scratch space once.
+/// Data big enough for @ref MIMPI_Reduce to use the reduce-scatter and
+/// gather are reduced the same way, with buffers allocated at every start.
+/// Started and completed like requests of @ref MIMPI_Bcast_init.
+///
+/// @param request - place where handle to the new request is to be put.
+/// @return MIMPI return code: same as @ref MIMPI_Bcast_init.
+///
+MIMPI_Retcode MIMPI_Reduce_init(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Op op,
+    int root,
+    MIMPI_Request *request
+);
+
+/// @brief Signals that this process has reached a barrier.
+///
+/// First half of a split-phase barrier: returns at once, so that
+/// the process may do work not depending on the others before
+/// @ref MIMPI_Barrier_end. The barrier is performed in the background,
+/// like @ref MIMPI_Ibarrier. Calling it again before
+/// @ref MIMPI_Barrier_end first ends the previous barrier.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation started successfully.
+///
+MIMPI_Retcode MIMPI_Barrier_begin();
+
+/// @brief Waits until all processes have reached the barrier.
+///
+/// Second half of a split-phase barrier started with
+/// @ref MIMPI_Barrier_begin. Does nothing if no barrier was begun.
+///
+/// @return MIMPI return code: same as @ref MIMPI_Barrier.
+///
+MIMPI_Retcode MIMPI_Barrier_end();
+
+/// @brief Arranges processes in a Cartesian grid.
+///
+/// Process with rank `r` gets coordinates of `r` in the grid in row-major
+/// order (the last dimension changes fastest). Its neighbours are the
+/// processes one step down and one step up each dimension, in this order.
+/// In a periodic dimension the grid wraps around, in other ones processes
+/// on its edges lack one of these neighbours (`MIMPI_PROC_NULL`).
+/// Has to be called with the same arguments by all processes.
+///
+/// @param ndims - number of dimensions of the grid, at most 32.
+/// @param dims - size of the grid in every dimension; their product has to
+///               be the world's size.
+/// @param periods - whether the grid wraps around in every dimension.
+/// @param reorder - whether ranks may be reordered to put neighbours close
+///                  to each other; all processes of the world are equally
+///                  close, so no reordering is ever needed.
+/// @param topology - place where handle to the new topology is to be put.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_INVALID_TOPOLOGY` if the grid doesn't have
+///           exactly one place for every process.
+///
+MIMPI_Retcode MIMPI_Cart_create(
+    int ndims,
+    int const *dims,
+    bool const *periods,
+    bool reorder,
+    MIMPI_Topology *topology
+);
+
+/// @brief Finds coordinates of a process in a Cartesian grid.
+///
+/// @param topology - topology created by @ref MIMPI_Cart_create.
+/// @param rank - rank of the process.
+/// @param coords - place where its coordinates are to be put.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_INVALID_TOPOLOGY` if @ref topology isn't a grid.
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if there is no process with rank
+///           @ref rank in the world.
+///
+MIMPI_Retcode MIMPI_Cart_coords(MIMPI_Topology topology, int rank, int *coords);
+
+/// @brief Arranges processes in a directed graph.
+///
+/// Every process tells who sends to it and to whom it sends.
+/// An edge from process `a` to `b` has to be listed both among
+/// @ref destinations of `a` and among @ref sources of `b`; repeated edges
+/// are matched in the order they are listed. A process may be its own
+/// neighbour.
+///
+/// @param indegree - number of processes sending to this one.
+/// @param sources - ranks of processes sending to this one.
+/// @param outdegree - number of processes this one sends to.
+/// @param destinations - ranks of processes this one sends to.
+/// @param reorder - see @ref MIMPI_Cart_create.
+/// @param topology - place where handle to the new topology is to be put.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_NO_SUCH_RANK` if a neighbour isn't in the world.
+///         - `MIMPI_ERROR_INVALID_TOPOLOGY` if a degree is negative.
+///
+MIMPI_Retcode MIMPI_Dist_graph_create(
+    int indegree,
+    int const *sources,
+    int outdegree,
+    int const *destinations,
+    bool reorder,
+    MIMPI_Topology *topology
+);
+
+/// @brief Lists neighbours of this process in a topology.
+///
+/// @param indegree - place where the number of processes sending to this one
+///                   is to be put.
+/// @param sources - if not NULL, place where their ranks are to be put.
+/// @param outdegree - place where the number of processes this one sends to
+///                    is to be put.
+/// @param destinations - if not NULL, place where their ranks are to be put.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///
+MIMPI_Retcode MIMPI_Topology_neighbors(
+    MIMPI_Topology topology,
+    int *indegree,
+    int *sources,
+    int *outdegree,
+    int *destinations
+);
+
+/// @brief Frees a topology and sets it to `MIMPI_TOPOLOGY_NULL`.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///
+MIMPI_Retcode MIMPI_Topology_free(MIMPI_Topology *topology);
+
+/// @brief Sends the same data to all neighbours and gathers data from them.
+///
+/// Sends @ref count bytes of data at @ref send_data to every destination of
+/// this process in @ref topology. Data from its `i`-th source are put at
+/// `recv_data + i * count`, data from `MIMPI_PROC_NULL` are left untouched.
+/// Receives from all neighbours are posted before anything is sent,
+/// so all neighbour links are used at once.
+/// All processes have to call it with the same @ref topology.
+///
+/// @param send_data - data to be sent.
+/// @param recv_data - place where received data are to be put,
+///                    `indegree * count` bytes.
+/// @param count - number of bytes of data sent to every neighbour.
+/// @param topology - topology whose neighbours exchange data.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if a source has already
+///            escaped _MPI block_.
+///         - `MIMPI_ERROR_DEADLOCK_DETECTED` if a deadlock has been detected
+///           and therefore this call would else never return.
+///
+MIMPI_Retcode MIMPI_Neighbor_allgather(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Topology topology
+);
+
+/// @brief Sends separate data to every neighbour and gathers data from them.
+///
+/// Works like @ref MIMPI_Neighbor_allgather, but the `j`-th destination
+/// gets @ref count bytes of data at `send_data + j * count`.
+///
+/// @return MIMPI return code: same as @ref MIMPI_Neighbor_allgather.
+///
+MIMPI_Retcode MIMPI_Neighbor_alltoall(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Topology topology
+);
+
+/// @brief Splits a communicator into disjoint ones.
+///
+/// Processes of @ref comm passing the same @ref color get a new communicator
+/// together, ranked by @ref key, ties broken by rank in @ref comm.
+/// Messages and collectives within the new communicator never interfere
+/// with those of any other, so collectives of different communicators
+/// may run at the same time (e.g. in different threads).
+/// Has to be called by all processes of @ref comm, like a collective.
+///
+/// @param comm - communicator to be split.
+/// @param color - processes with the same color end up together; a process
+///                passing a negative color gets no new communicator and
+///                @ref newcomm is left untouched.
+/// @param key - decides the order of ranks in the new communicator.
+/// @param newcomm - place where handle to the new communicator is to be put.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///         - `MIMPI_ERROR_REMOTE_FINISHED` if any process of @ref comm
+///            has already escaped _MPI block_.
+///
+MIMPI_Retcode MIMPI_Comm_split(
+    MIMPI_Comm comm,
+    int color,
+    int key,
+    MIMPI_Comm *newcomm
+);
+
+/// @brief Creates a copy of a communicator with its own space of messages.
+///
+/// Works like @ref MIMPI_Comm_split with the same color and key equal to
+/// the rank in @ref comm for all processes.
+///
+/// @return MIMPI return code: same as @ref MIMPI_Comm_split.
+///
+MIMPI_Retcode MIMPI_Comm_dup(MIMPI_Comm comm, MIMPI_Comm *newcomm);
+
+/// @brief Frees a communicator and sets it to `MIMPI_COMM_WORLD`.
+///
+/// Does nothing for `MIMPI_COMM_WORLD`.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///
+MIMPI_Retcode MIMPI_Comm_free(MIMPI_Comm *comm);
+
+/// @brief Obtains rank of this process in a communicator.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///
+MIMPI_Retcode MIMPI_Comm_rank(MIMPI_Comm comm, int *rank);
+
+/// @brief Obtains the number of processes in a communicator.
+///
+/// @return MIMPI return code:
+///         - `MIMPI_SUCCESS` if operation ended successfully.
+///
+MIMPI_Retcode MIMPI_Comm_size(MIMPI_Comm comm, int *size);
+
+/// @brief Sends data to a process of a communicator.
+///
+/// Works like @ref MIMPI_Send, with @ref destination being a rank
+/// in @ref comm. The message can only be received within @ref comm.
+///
+/// @return MIMPI return code: same as @ref MIMPI_Send.
+///
+MIMPI_Retcode MIMPI_Comm_send(
+    void const *data,
+    int count,
+    int destination,
+    int tag,
+    MIMPI_Comm comm
+);
+
+/// @brief Receives data from a process of a communicator.
+///
+/// Works like @ref MIMPI_Recv, with @ref source being a rank in @ref comm.
+/// Only messages sent within @ref comm match.
+///
+/// @return MIMPI return code: same as @ref MIMPI_Recv.
+///
+MIMPI_Retcode MIMPI_Comm_recv(
+    void *data,
+    int count,
+    int source,
+    int tag,
+    MIMPI_Comm comm
+);
+
+/// @brief Synchronises processes of a communicator.
+///
+/// Works like @ref MIMPI_Barrier among processes of @ref comm only.
+///
+/// @return MIMPI return code: same as @ref MIMPI_Barrier.
+///
+MIMPI_Retcode MIMPI_Comm_barrier(MIMPI_Comm comm);
+
+/// @brief Broadcasts data to processes of a communicator.
+///
+/// Works like @ref MIMPI_Bcast among processes of @ref comm only,
+/// with @ref root being a rank in @ref comm.
+///
+/// @return MIMPI return code: same as @ref MIMPI_Bcast.
+///
+MIMPI_Retcode MIMPI_Comm_bcast(
+    void *data,
+    int count,
+    int root,
+    MIMPI_Comm comm
+);
+
+/// @brief Reduces data from processes of a communicator to one.
+///
+/// Works like @ref MIMPI_Reduce among processes of @ref comm only,
+/// with @ref root being a rank in @ref comm. Data of any size go up
+/// the (pipelined) tree, never with the reduce-scatter and gather.
+///
+/// @return MIMPI return code: same as @ref MIMPI_Reduce.
+///
+MIMPI_Retcode MIMPI_Comm_reduce(
+    void const *send_data,
+    void *recv_data,
+    int count,
+    MIMPI_Op op,
+    int root,
+    MIMPI_Comm comm
 );
 
 #endif /* MIMPI_H */
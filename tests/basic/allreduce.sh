@@ -0,0 +1,6 @@
+set -ex
+./run_test 1 1 examples_build/allreduce 100
+./run_test 1 3 examples_build/allreduce 2137
+./run_test 1 4 examples_build/allreduce 3
+./run_test 2 5 examples_build/allreduce 100000
+./run_test 3 16 examples_build/allreduce 100003
@@ -0,0 +1,6 @@
+set -ex
+./run_test 1 1 examples_build/alltoall
+./run_test 1 2 examples_build/alltoall
+./run_test 1 5 examples_build/alltoall
+./run_test 2 8 examples_build/alltoall
+./run_test 3 16 examples_build/alltoall
@@ -0,0 +1,6 @@
+set -ex
+./run_test 1 1 examples_build/barrier_algorithms
+./run_test 1 2 examples_build/barrier_algorithms
+./run_test 1 5 examples_build/barrier_algorithms
+./run_test 2 16 examples_build/barrier_algorithms
+MIMPI_BARRIER=dissemination ./run_test 1 4 examples_build/barrier_remote_finish
@@ -0,0 +1,2 @@
+set -ex
+./run_test 1 4 examples_build/comm_remote_finish
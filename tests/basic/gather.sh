@@ -0,0 +1,6 @@
+set -ex
+./run_test 1 1 examples_build/gather 10
+./run_test 1 3 examples_build/gather 0
+./run_test 1 5 examples_build/gather 100
+./run_test 2 6 examples_build/gather 3000
+./run_test 3 16 examples_build/gather 1000
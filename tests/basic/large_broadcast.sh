@@ -0,0 +1,12 @@
+set -ex
+./run_test 1 1 examples_build/large_broadcast 100000
+./run_test 1 3 examples_build/large_broadcast 0
+./run_test 1 4 examples_build/large_broadcast 16383
+./run_test 2 5 examples_build/large_broadcast 100003
+./run_test 3 16 examples_build/large_broadcast 1000000
+MIMPI_BCAST_SEGMENT=1000 ./run_test 2 16 examples_build/large_broadcast 123457
+MIMPI_BCAST_SEGMENT=1 ./run_test 2 7 examples_build/large_broadcast 1000
+./run_test 2 3 examples_build/large_broadcast 1048576
+./run_test 5 16 examples_build/large_broadcast 3000017
+./run_test 2 5 examples_build/large_broadcast 100003 persistent
+./run_test 5 6 examples_build/large_broadcast 2000003 persistent
@@ -0,0 +1,19 @@
+set -ex
+./run_test 1 1 examples_build/large_reduce 100000
+./run_test 1 3 examples_build/large_reduce 0
+./run_test 1 4 examples_build/large_reduce 16383
+./run_test 2 5 examples_build/large_reduce 100003
+./run_test 3 16 examples_build/large_reduce 1000000
+MIMPI_REDUCE_SEGMENT=1000 ./run_test 2 16 examples_build/large_reduce 123457
+MIMPI_REDUCE_SEGMENT=1 ./run_test 2 7 examples_build/large_reduce 1000
+MIMPI_REDUCE_RABENSEIFNER=4194304 ./run_test 5 3 examples_build/large_reduce 4194304 0
+MIMPI_REDUCE_RABENSEIFNER=4194304 ./run_test 5 5 examples_build/large_reduce 4194305 3
+MIMPI_REDUCE_RABENSEIFNER=4194304 ./run_test 5 7 examples_build/large_reduce 5000003 2
+MIMPI_REDUCE_RABENSEIFNER=4194304 ./run_test 5 8 examples_build/large_reduce 4194304 5
+MIMPI_REDUCE_RABENSEIFNER=4194304 ./run_test 10 16 examples_build/large_reduce 4200000 0
+./run_test 2 5 examples_build/large_reduce 100003 1 persistent
+./run_test 5 5 examples_build/large_reduce 4194305 0 persistent
+MIMPI_REDUCE_RABENSEIFNER=4194304 ./run_test 10 16 examples_build/large_reduce 4200000 9 persistent
+MIMPI_REDUCE_RABENSEIFNER=1000 ./run_test 2 6 examples_build/large_reduce 100003 4
+./run_test 5 8 examples_build/large_reduce 4194304 5
+MIMPI_REDUCE_RABENSEIFNER=1000 ./run_test 2 7 examples_build/large_reduce 100003 2 persistent
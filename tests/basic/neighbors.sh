@@ -0,0 +1,6 @@
+set -ex
+./run_test 1 1 examples_build/neighbors
+./run_test 1 2 examples_build/neighbors
+./run_test 1 5 examples_build/neighbors
+./run_test 1 8 examples_build/neighbors
+./run_test 2 16 examples_build/neighbors
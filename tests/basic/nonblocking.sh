@@ -0,0 +1,5 @@
+set -ex
+./run_test 1 1 examples_build/nonblocking
+./run_test 1 2 examples_build/nonblocking
+./run_test 1 5 examples_build/nonblocking
+./run_test 2 16 examples_build/nonblocking
@@ -0,0 +1,4 @@
+set -ex
+./run_test 2 2 examples_build/persistent
+./run_test 2 3 examples_build/persistent
+./run_test 4 8 examples_build/persistent
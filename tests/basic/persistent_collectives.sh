@@ -0,0 +1,5 @@
+set -ex
+./run_test 1 1 examples_build/persistent_collectives
+./run_test 2 2 examples_build/persistent_collectives
+./run_test 2 5 examples_build/persistent_collectives
+./run_test 3 16 examples_build/persistent_collectives
@@ -0,0 +1,3 @@
+set -ex
+./run_test 1 2 examples_build/probe
+./run_test 1 5 examples_build/probe
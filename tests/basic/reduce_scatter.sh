@@ -0,0 +1,6 @@
+set -ex
+./run_test 1 1 examples_build/reduce_scatter 100
+./run_test 1 3 examples_build/reduce_scatter 1
+./run_test 1 4 examples_build/reduce_scatter 1000
+./run_test 2 7 examples_build/reduce_scatter 10000
+./run_test 3 16 examples_build/reduce_scatter 5000
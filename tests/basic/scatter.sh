@@ -0,0 +1,6 @@
+set -ex
+./run_test 1 1 examples_build/scatter 10
+./run_test 1 3 examples_build/scatter 0
+./run_test 1 5 examples_build/scatter 100
+./run_test 2 7 examples_build/scatter 3000
+./run_test 3 16 examples_build/scatter 1000
@@ -0,0 +1,4 @@
+set -ex
+./run_test 1 2 examples_build/sendrecv 10
+./run_test 1 5 examples_build/sendrecv 1000
+./run_test 2 8 examples_build/sendrecv 300000
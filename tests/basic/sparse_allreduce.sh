@@ -0,0 +1,7 @@
+set -ex
+./run_test 1 1 examples_build/sparse_allreduce 100 10
+./run_test 1 3 examples_build/sparse_allreduce 2137 1
+./run_test 1 4 examples_build/sparse_allreduce 3 2
+./run_test 2 5 examples_build/sparse_allreduce 100000 1000
+./run_test 3 16 examples_build/sparse_allreduce 100003 3
+./run_test 3 16 examples_build/sparse_allreduce 1000000 10007
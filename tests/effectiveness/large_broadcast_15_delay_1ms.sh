@@ -0,0 +1 @@
+DELAY=1 ./run_test 0.7s 15 examples_build/large_broadcast 65536
@@ -0,0 +1 @@
+DELAY=1 ./run_test 0.4s 16 examples_build/large_reduce 65536